@@ -1,5 +1,6 @@
 import shutil
 import subprocess
+import sys
 from pathlib import Path
 
 # CONFIG
@@ -12,6 +13,7 @@ compiler_flags = [
     "-Wno-missing-braces",
     "-std=c++20",
     "-DNOMINMAX=1",  # Windows.h name-squats common identifiers if this is not defined
+    "-ffp-contract=off",  # fused multiply-adds round differently, the SIMD noise has to match the scalar one exactly
 ]
 
 if defines["ENGINE_SLOW"] == "1":
@@ -27,6 +29,50 @@ linker_flags = [
     "-Wl,/LTCG",  # windows linker flag to remove indirection in dll calls, makes debugging easier
 ]
 
+# TESTS
+# NOTE: `python build.py terrain_golden` only builds and runs the headless terrain
+# test. It doesn't need the platform layer or the Vulkan SDK, so it also works on Linux.
+test_name = "terrain_golden"
+test_source_files = ["tests/terrain_golden.cpp", "src/terrain.cpp", "src/noise.cpp"]
+test_defines = {"ENGINE_SLOW": "0", "ENGINE_INTERNAL": "0"}
+test_compiler_flags = [
+    "-fdiagnostics-absolute-paths",
+    "-Wall",
+    "-Wno-missing-braces",
+    "-std=c++20",
+    "-ffp-contract=off",  # same float results as the game
+    "-O2",
+]
+
+if test_name in sys.argv[1:]:
+    test_project_dir = Path(__file__).parent
+    test_build_dir = test_project_dir / "build"
+    test_build_dir.mkdir(exist_ok=True)
+
+    test_exe = test_build_dir / (test_name + (".exe" if sys.platform == "win32" else ""))
+    test_defines_str = " ".join([f"-D{name}={value}" for (name, value) in test_defines.items()])
+    test_compiler_flags_str = " ".join(test_compiler_flags)
+    test_sources_str = " ".join([str(test_project_dir / source) for source in test_source_files])
+    test_libs_str = "" if sys.platform == "win32" else "-lm"
+
+    test_compile_cmd = f"clang \
+{test_defines_str} \
+{test_compiler_flags_str} \
+{test_sources_str} \
+-o {str(test_exe)} \
+{test_libs_str} \
+"
+
+    print(f"BUILDING {test_name.upper()}...")
+    test_result = subprocess.run(test_compile_cmd, shell=True, capture_output=True, text=True)
+    if test_result.returncode != 0:
+        print(test_result.stderr.strip())
+        print(test_result.stdout.strip())
+        exit(-1)
+
+    print(f"RUNNING {test_name.upper()}...")
+    exit(subprocess.run(str(test_exe), shell=True).returncode)
+
 vk_sdk_root = Path("C:/VulkanSDK/")
 vk_sdks = list(vk_sdk_root.glob("*"))
 if len(vk_sdks) == 0:
@@ -49,6 +95,7 @@ game_source_files = [
     "src/maths.cpp",
     "src/noise.cpp",
     "src/world.cpp",
+    "src/terrain.cpp",
     "src/img.cpp",
     "src/gpu.cpp",
     "src/str.cpp"
@@ -1,8 +1,8 @@
 #version 450
 
 // NOTE: Vertex attributes
-layout(location = 0) in vec3 in_position;
-layout(location = 1) in vec3 in_normal;
+// The vertex is packed in a single uint, see ChunkVertex in world.h.
+layout(location = 0) in uint in_packed;
 
 // NOTE: Outputs to the fragment shader
 layout(location = 0) out vec4 v_color;
@@ -19,16 +19,43 @@ layout(set = 0, binding = 1) uniform ProjMatBuffer {
     mat4 proj;
 };
 
+// NOTE: Normals in the same order as the FaceDirection enum.
+const vec3 FACE_NORMALS[6] = vec3[6](
+    vec3( 1.0,  0.0,  0.0),
+    vec3(-1.0,  0.0,  0.0),
+    vec3( 0.0,  1.0,  0.0),
+    vec3( 0.0, -1.0,  0.0),
+    vec3( 0.0,  0.0,  1.0),
+    vec3( 0.0,  0.0, -1.0)
+);
+
+// NOTE: Colors in the same order as the BlockType enum.
+// TODO: Research this whole linear <-> sRGB situation.
+const vec4 BLOCK_COLORS[5] = vec4[5](
+    vec4(1.0,   0.0,   1.0,   1.0), // air, never meshed
+    vec4(0.2,   0.2,   0.2,   1.0), // stone
+    vec4(0.15,  0.09,  0.04,  1.0), // dirt
+    vec4(0.073, 0.133, 0.073, 1.0), // grass
+    vec4(1.0,   1.0,   1.0,   1.0)  // snow
+);
+
 void main() {
-    vec4 world_pos = model * vec4(in_position, 1.0);
-    gl_Position = proj * view * world_pos;
+    // NOTE: Unpack the vertex.
+    vec3 position = vec3(
+        float(in_packed & 31u),
+        float((in_packed >> 5u) & 31u),
+        float((in_packed >> 10u) & 31u)
+    );
+    uint face = (in_packed >> 15u) & 7u;
+    uint ao = (in_packed >> 18u) & 3u;
+    uint block_type = (in_packed >> 20u) & 255u;
 
-    // TODO: Research this whole linear <-> sRGB situation.
-    vec4 mountain_color = vec4(1.0, 1.0, 1.0, 1.0);
-    vec4 grass_color    = vec4(0.073, 0.133, 0.073, 1.0);
+    vec4 world_pos = model * vec4(position, 1.0);
+    gl_Position = proj * view * world_pos;
 
-    float t = pow(world_pos.y / (16.0 * 3.0), 4.0);
+    // NOTE: Each level of ambient occlusion darkens the vertex a bit.
+    float ao_factor = 1.0 - 0.2 * float(ao);
 
-    v_color = mix(grass_color, mountain_color, t);
-    v_normal = in_normal;
+    v_color = BLOCK_COLORS[min(block_type, 4u)] * vec4(vec3(ao_factor), 1.0);
+    v_normal = FACE_NORMALS[face];
 }
@@ -1,7 +1,8 @@
 #version 450
 
 // NOTE: Vertex attributes.
-layout (location = 0) in vec3 in_position;
+// The chunk vertex is packed in a single uint, see ChunkVertex in world.h.
+layout (location = 0) in uint in_packed;
 
 // NOTE: Outputs to the fragment shader.
 layout(location = 0) out vec4 v_color;
@@ -21,6 +22,11 @@ layout(set = 0, binding = 1) uniform ProjMatBuffer {
 
 void main()
 {
-    gl_Position = proj * view * model * vec4(in_position, 1);
+    vec3 position = vec3(
+        float(in_packed & 31u),
+        float((in_packed >> 5u) & 31u),
+        float((in_packed >> 10u) & 31u)
+    );
+    gl_Position = proj * view * model * vec4(position, 1);
     v_color = color;
 }
@@ -24,6 +24,13 @@ struct Pool {
     u16 free_stack[N];
     u16* free_stack_ptr;
     u16 nb_allocated;
+
+    // NOTE: The allocated slots, packed at the start of the array, so that
+    // loops over the live items don't have to look at the whole pool. An
+    // item is removed by moving the last one in its place, so the order
+    // changes on release.
+    u16 allocated_slots[N];
+    u16 allocated_slot_positions[N];
 };
 
 template <typename T, usize N>
@@ -53,6 +60,9 @@ T* PoolAcquireItem(Pool<T, N>* pool) {
     u16 slot = *(pool->free_stack_ptr);
 
     pool->free_stack_ptr--;
+
+    pool->allocated_slots[pool->nb_allocated] = slot;
+    pool->allocated_slot_positions[slot] = pool->nb_allocated;
     pool->nb_allocated++;
 
     return pool->slots + slot;
@@ -74,9 +84,23 @@ void PoolReleaseItem(Pool<T, N>* pool, T* item) {
     pool->free_stack_ptr++;
     *(pool->free_stack_ptr) = slot;
 
+    u16 position = pool->allocated_slot_positions[slot];
+    u16 last_slot = pool->allocated_slots[pool->nb_allocated - 1];
+    pool->allocated_slots[position] = last_slot;
+    pool->allocated_slot_positions[last_slot] = position;
+
     pool->nb_allocated--;
 }
 
+// NOTE: Releasing an item moves the last allocated one to its position, so
+// loops that release items while iterating have to go backwards.
+template <typename T, usize N>
+T* PoolGetAllocatedItem(Pool<T, N>* pool, u16 position) {
+    ASSERT(position < pool->nb_allocated);
+
+    return pool->slots + pool->allocated_slots[position];
+}
+
 // BUDDY
 
 // NOTE: This is a good resource, albeit a bit confusing. Most of
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "common.h"
+#include "maths.h"
+
+// NOTE: The chunk definitions that don't depend on the GPU, so that the
+// terrain generator can be built without the platform and Vulkan headers.
+// Everything about loaded chunks and their meshes is in world.h.
+
+constexpr i32 CHUNK_W = 16;
+
+constexpr v3i worldPosToChunk(v3 world_pos) {
+    v3 chunk_pos = world_pos / CHUNK_W;
+
+    return v3i {
+        mfloor(chunk_pos.x()),
+        mfloor(chunk_pos.y()),
+        mfloor(chunk_pos.z()),
+    };
+}
+
+constexpr v3 chunkToWorldPos(v3i chunk_pos) {
+    return v3 {
+        (f32)(chunk_pos.x() * CHUNK_W),
+        (f32)(chunk_pos.y() * CHUNK_W),
+        (f32)(chunk_pos.z() * CHUNK_W)
+    };
+}
+
+// NOTE: How many chunks to load around the player, in ALL 3 directions.
+// A radius of 1 would mean 7 chunks in a diamond pattern, the center one
+// being the chunk the player is inside.
+constexpr i32 LOAD_RADIUS = 8;
+
+// NOTE: Loaded chunks are only unloaded past this radius, so that walking
+// back and forth across a chunk border doesn't unload and reload the same
+// shell of chunks every time.
+constexpr i32 UNLOAD_RADIUS = LOAD_RADIUS + 1;
+static_assert(UNLOAD_RADIUS >= LOAD_RADIUS);
+
+// NOTE: The block palette. Air is zero and everything else is solid, that's
+// all the meshers and the raycast need to know. Stone is one, so that the
+// uniform solid chunks deep underground are stone. The colors are in
+// debug_chunk.vert, in the same order.
+enum BlockType : u8 {
+    BLOCK_AIR,
+    BLOCK_STONE,
+    BLOCK_DIRT,
+    BLOCK_GRASS,
+    BLOCK_SNOW,
+    BLOCK_TYPE_COUNT,
+};
+
+// NOTE: The blocks of a chunk. They live in their own pool, because a lot
+// of the loaded chunks are only air (above the terrain) or only solid blocks
+// (below it) and don't need to store them.
+struct ChunkBlocks {
+    u8 data[CHUNK_W * CHUNK_W * CHUNK_W];
+};
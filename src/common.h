@@ -40,3 +40,21 @@ typedef int32_t b32;
 #define TERABYTES(value) (GIGABYTES(value) * 1024LL)
 
 #define USED(variable) (void)variable;
+
+// NOTE: For the data the game shares with the worker threads. These are
+// compiler builtins, so the game code doesn't need the platform headers.
+inline u32 atomicFetchAddU32(volatile u32* value, u32 addend) {
+    return __atomic_fetch_add(value, addend, __ATOMIC_SEQ_CST);
+}
+
+// NOTE: Everything written before the release store is visible to the thread
+// that reads the pointer with the acquire load.
+template <typename T>
+inline void atomicStorePointerRelease(T* volatile* pointer, T* value) {
+    __atomic_store_n(pointer, value, __ATOMIC_RELEASE);
+}
+
+template <typename T>
+inline T* atomicLoadPointerAcquire(T* volatile* pointer) {
+    return __atomic_load_n(pointer, __ATOMIC_ACQUIRE);
+}
@@ -4,6 +4,15 @@
 
 // HASHMAP
 
+// NOTE: Used to size the hashmaps at compile time.
+constexpr usize nextPowerOfTwo(usize n) {
+    usize value = 2;
+    while (value < n) {
+        value *= 2;
+    }
+    return value;
+}
+
 template <typename V, typename K>
 struct HashmapEntry {
     usize hash;
@@ -222,3 +231,95 @@ struct SStack {
         return data[top];
     }
 };
+
+// PRIORITY QUEUE
+
+// NOTE: Fixed size binary min-heap : pop returns the element with the lowest
+// priority. All zeroes is a valid empty queue.
+template <typename T, usize N>
+struct SPriorityQueue {
+    T data[N];
+    f32 priorities[N];
+    usize count;
+
+    b32 is_empty() {
+        return count == 0;
+    }
+
+    usize free_count() {
+        return N - count;
+    }
+
+    void push(const T& element, f32 priority) {
+        ASSERT(count < N);
+        if (count == N) return;
+
+        data[count] = element;
+        priorities[count] = priority;
+        count++;
+        sift_up(count - 1);
+    }
+
+    T& peek() {
+        ASSERT(count > 0);
+
+        return data[0];
+    }
+
+    T pop() {
+        ASSERT(count > 0);
+
+        T element = data[0];
+        count--;
+        if (count > 0) {
+            data[0] = data[count];
+            priorities[0] = priorities[count];
+            sift_down(0);
+        }
+        return element;
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    // NOTE: Restores the heap order after elements or priorities were
+    // changed in place.
+    void heapify() {
+        for (usize idx = count / 2; idx-- > 0;) {
+            sift_down(idx);
+        }
+    }
+
+    void swap(usize a, usize b) {
+        T tmp_element = data[a];
+        data[a] = data[b];
+        data[b] = tmp_element;
+
+        f32 tmp_priority = priorities[a];
+        priorities[a] = priorities[b];
+        priorities[b] = tmp_priority;
+    }
+
+    void sift_up(usize idx) {
+        while (idx > 0) {
+            usize parent = (idx - 1) / 2;
+            if (priorities[parent] <= priorities[idx]) break;
+            swap(parent, idx);
+            idx = parent;
+        }
+    }
+
+    void sift_down(usize idx) {
+        while (true) {
+            usize smallest = idx;
+            usize left = idx * 2 + 1;
+            usize right = idx * 2 + 2;
+            if (left < count && priorities[left] < priorities[smallest]) smallest = left;
+            if (right < count && priorities[right] < priorities[smallest]) smallest = right;
+            if (smallest == idx) break;
+            swap(smallest, idx);
+            idx = smallest;
+        }
+    }
+};
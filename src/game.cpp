@@ -11,6 +11,7 @@
 #include "noise.h"
 #include "gpu.h"
 #include "world.h"
+#include "terrain.h"
 #include "str.h"
 
 struct TextRenderingState {
@@ -68,13 +69,12 @@ void textRenderingInitialize(TextRenderingState* text_rendering_state, Renderer*
     text_rendering_state->bitmap_font = image_allocation.image;
     text_rendering_state->bitmap_font_view = image_allocation.image_view;
 
-    // NOTE: Get a staging buffer, and write the image bytes to it.
-    AllocatedBuffer* staging_buffer = rendererRequestStagingBuffer(renderer);
-    ASSERT(staging_buffer != nullptr);
-    ASSERT(staging_buffer->alloc.alloc_size >= bitmap_width * bitmap_height * 4);
+    // NOTE: Get some staging memory, and write the image bytes to it.
+    StagingAllocation staging = rendererRequestStagingMemory(renderer, bitmap_width * bitmap_height * 4);
+    ASSERT(staging.mapped_data != nullptr);
 
     for (u32 i = 0; i < bitmap_width * bitmap_height * 4; i++) {
-        staging_buffer->alloc.mapped_data[i] = bitmap_bytes[i];
+        staging.mapped_data[i] = bitmap_bytes[i];
     }
 
     // NOTE: Get the current frame's command buffer to record an upload
@@ -114,13 +114,14 @@ void textRenderingInitialize(TextRenderingState* text_rendering_state, Renderer*
 
     // NOTE: Record the actual copy command.
     VkBufferImageCopy copy_region = {};
+    copy_region.bufferOffset = staging.offset;
     copy_region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     copy_region.imageSubresource.baseArrayLayer = 0;
     copy_region.imageSubresource.layerCount = 1;
     copy_region.imageSubresource.mipLevel = 0;
     copy_region.imageExtent = {bitmap_width, bitmap_height, 1};
 
-    vkCmdCopyBufferToImage(cmd_buf, staging_buffer->buffer, text_rendering_state->bitmap_font, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy_region);
+    vkCmdCopyBufferToImage(cmd_buf, staging.buffer, text_rendering_state->bitmap_font, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy_region);
 
     // NOTE: Transition the image into a layout optimal for sampling.
     // We wait for the transfer to have finished before transitioning,
@@ -275,10 +276,9 @@ void chunkPipelineInitialize(Renderer* renderer, VulkanPipeline* to_create, Aren
     pipelineBuilderEnableBackfaceCulling(&builder);
     pipelineBuilderEnableDepth(&builder);
 
-    // NOTE: Add a vertex buffer and two vec3 for position and normals.
+    // NOTE: Add a vertex buffer with a single packed uint per vertex.
     pipelineBuilderAddVertexInputBinding(&builder, sizeof(ChunkVertex));
-    pipelineBuilderAddVertexAttribute(&builder, VK_FORMAT_R32G32B32_SFLOAT, 0);
-    pipelineBuilderAddVertexAttribute(&builder, VK_FORMAT_R32G32B32_SFLOAT, sizeof(v3));
+    pipelineBuilderAddVertexAttribute(&builder, VK_FORMAT_R32_UINT, 0);
 
     // NOTE: Two uniform buffers for the view and proj matrices.
     // The model matrix is handled with a push constant so we don't have
@@ -306,10 +306,9 @@ void wireframePipelineInitialize(Renderer* renderer, VulkanPipeline* to_create,
     pipelineBuilderEnableDepth(&builder);
     pipelineBuilderEnableWireframe(&builder);
 
-    // NOTE: Add a vertex buffer and two vec3 for position and normals.
+    // NOTE: Add a vertex buffer with a single packed uint per vertex.
     pipelineBuilderAddVertexInputBinding(&builder, sizeof(ChunkVertex));
-    pipelineBuilderAddVertexAttribute(&builder, VK_FORMAT_R32G32B32_SFLOAT, 0);
-    pipelineBuilderAddVertexAttribute(&builder, VK_FORMAT_R32G32B32_SFLOAT, sizeof(v3));
+    pipelineBuilderAddVertexAttribute(&builder, VK_FORMAT_R32_UINT, 0);
 
     // NOTE: Two uniform buffers for the view and proj matrices.
     // The model matrix is handled with a push constant so we don't have
@@ -325,24 +324,277 @@ void wireframePipelineInitialize(Renderer* renderer, VulkanPipeline* to_create,
     vkDestroyShaderModule(renderer->device, wireframe_frag_shader, nullptr);
 }
 
+// NOTE: All the chunk meshes are made of quads with the same index pattern,
+// so they all share a single index buffer covering the worst case mesh. It is
+// uploaded once, which needs a command buffer being recorded.
+void chunkIndexBufferInitialize(Renderer* renderer, AllocatedBuffer* to_create, VkCommandBuffer cmd_buf) {
+    constexpr usize index_buffer_size = MAX_CHUNK_INDICES * sizeof(u16);
+
+    *to_create = graphicsMemoryAllocateBuffer(
+        &renderer->vram_allocator,
+        index_buffer_size,
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+    );
+
+    StagingAllocation staging = rendererRequestStagingMemory(renderer, index_buffer_size);
+    ASSERT(staging.mapped_data != nullptr);
+
+    generateChunkQuadIndices((u16*)staging.mapped_data);
+
+    VkBufferCopy copy_region = {};
+    copy_region.srcOffset = staging.offset;
+    copy_region.dstOffset = 0;
+    copy_region.size = index_buffer_size;
+
+    vkCmdCopyBuffer(cmd_buf, staging.buffer, to_create->buffer, 1, &copy_region);
+
+    VkBufferMemoryBarrier2 transfer_barrier = {};
+    transfer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+    transfer_barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    transfer_barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    transfer_barrier.dstStageMask = VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT;
+    transfer_barrier.dstAccessMask = VK_ACCESS_2_INDEX_READ_BIT;
+    transfer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    transfer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    transfer_barrier.buffer = to_create->buffer;
+    transfer_barrier.size = index_buffer_size;
+
+    VkDependencyInfo transfer_barrier_dep_info = {};
+    transfer_barrier_dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    transfer_barrier_dep_info.pBufferMemoryBarriers = &transfer_barrier;
+    transfer_barrier_dep_info.bufferMemoryBarrierCount = 1;
+
+    vkCmdPipelineBarrier2(cmd_buf, &transfer_barrier_dep_info);
+}
+
+// NOTE: High resolution timestamps, for profiling.
+inline i64 getWallClock() {
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+inline f64 getSecondsElapsed(i64 start, i64 end) {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return (f64)(end - start) / (f64)frequency.QuadPart;
+}
+
+// NOTE: Average time spent per chunk by the different meshing paths, measured
+// over all the loaded chunks. Every path includes gathering the padded chunk,
+// which is also measured on its own. The face masks (and the face types) are
+// measured on their own too, since that is the face visibility pass of the
+// bitmask and greedy meshers.
+// NOTE: What the meshing benchmark measures. Every path starts by gathering
+// the padded chunk, so the gather path alone is the baseline of the others.
+enum MeshingBenchmarkPath {
+    MESHING_BENCHMARK_GATHER,
+    MESHING_BENCHMARK_NAIVE,
+    MESHING_BENCHMARK_FACE_MASKS,
+    MESHING_BENCHMARK_BITMASK,
+    MESHING_BENCHMARK_GREEDY,
+    MESHING_BENCHMARK_GREEDY_COUNT,
+    MESHING_BENCHMARK_PATH_COUNT,
+};
+
+// NOTE: In the order of MeshingBenchmarkPath, for the overlay.
+inline constexpr const char* MESHING_BENCHMARK_PATH_NAMES[] = {
+    "gather",
+    "naive",
+    "face masks",
+    "bitmask",
+    "greedy",
+    "greedy count",
+};
+static_assert(ARRAY_COUNT(MESHING_BENCHMARK_PATH_NAMES) == MESHING_BENCHMARK_PATH_COUNT);
+
+struct MeshingBenchmark {
+    b32 has_run;
+    usize chunks_count;
+    f64 microseconds[MESHING_BENCHMARK_PATH_COUNT];
+};
+
+// NOTE: Generation only, on chunks that are not in the world, so it doesn't
+// depend on what is loaded and the heightmap cache is bypassed. It runs on
+// the main thread, so the rates are for one core. The generated blocks are
+// checked against golden hashes by tests/terrain_golden.cpp.
+struct TerrainBenchmark {
+    b32 has_run;
+    f64 mvoxels_per_second[TERRAIN_PRESETS_COUNT];
+};
+
+// NOTE: The chunks are generated on the platform worker threads, one job per
+// column of chunks to load, so that the heightmap is computed once for all of
+// them. The main thread takes the chunks and their blocks from the pools and
+// puts the chunks in the world before queueing the job, so they are not
+// loaded twice, but they are only usable once the job is integrated back.
+constexpr u32 CHUNK_GENERATION_JOBS_COUNT = 256;
+static_assert(CHUNK_GENERATION_JOBS_COUNT < PLATFORM_WORK_QUEUE_SIZE);
+constexpr u32 CHUNK_GENERATION_COLUMN_H = LOAD_RADIUS * 2 + 1;
+
+// NOTE: How many generated chunks are put in the world per frame, since they
+// all need meshing right after. Whole jobs are integrated, so it can go over
+// by a column.
+constexpr u32 CHUNK_INTEGRATION_BUDGET = 128;
+
+struct ChunkGenerationCompletionQueue;
+
+struct ChunkGenerationJob {
+    // NOTE: Written by the main thread before the job is queued. The worker
+    // only uses the heightmap if it was cached, and generates it otherwise.
+    TerrainDescription terrain;
+    i32 chunk_x;
+    i32 chunk_z;
+    b32 has_cached_heightmap;
+    ChunkHeightmap heightmap;
+
+    u32 chunks_count;
+    i32 chunk_ys[CHUNK_GENERATION_COLUMN_H];
+    Chunk* chunks[CHUNK_GENERATION_COLUMN_H];
+    ChunkBlocks* blocks[CHUNK_GENERATION_COLUMN_H];
+
+    // NOTE: Written by the worker.
+    b32 is_uniform[CHUNK_GENERATION_COLUMN_H];
+    u8 uniform_blocks[CHUNK_GENERATION_COLUMN_H];
+
+    ChunkGenerationCompletionQueue* completion_queue;
+};
+
+// NOTE: The workers push the jobs they finished, and the main thread pops
+// them. A worker reserves its entry with an atomic add, and then publishes
+// the job pointer in it, so the main thread stops at the first entry still
+// empty. There are never more jobs than entries, so a reserved entry has
+// always been read already.
+struct ChunkGenerationCompletionQueue {
+    ChunkGenerationJob* volatile entries[CHUNK_GENERATION_JOBS_COUNT];
+    volatile u32 next_entry_to_write;
+    u32 next_entry_to_read;
+};
+
+// NOTE: The columns of chunks waiting to be loaded. Enough for the whole
+// sphere, and a lot of steps of shells behind it.
+constexpr usize CHUNK_LOAD_QUEUE_SIZE = 4096;
+
+// NOTE: How long the main thread can spend per frame on putting queued
+// chunks in the world and queueing their generation, and on meshing the
+// dirty chunks. At least one column / one chunk is always handled, so the
+// world keeps streaming even in slow builds.
+constexpr f64 CHUNK_LOAD_BUDGET_MICROSECONDS = 1000.0;
+constexpr f64 CHUNK_REMESH_BUDGET_MICROSECONDS = 4000.0;
+
+// NOTE: The chunks around where the player will be this far ahead are
+// prefetched, so that they are already there when sprinting. The prediction
+// is clamped to the load radius. Prefetched columns are only loaded once no
+// regular column is left in the queue.
+constexpr f32 CHUNK_PREFETCH_SECONDS = 0.25f;
+constexpr f32 CHUNK_PREFETCH_PRIORITY_OFFSET = LOAD_RADIUS * 4.0f;
+// NOTE: How much the measured velocity moves toward the last frame's one.
+constexpr f32 PLAYER_VELOCITY_SMOOTHING = 0.2f;
+
+struct ChunkColumnLoad {
+    v2i column;
+    // NOTE: Prefetched columns are loaded around the prefetch center instead
+    // of the streaming center.
+    b32 is_prefetch;
+};
+
+using ChunkRemeshQueue = SPriorityQueue<Chunk*, CHUNK_POOL_SIZE>;
+
+// NOTE: The blocks of the last chunks unloaded, so that a chunk coming back
+// soon after is revived instead of generated again. This also keeps the
+// blocks the player removed there for a while. When full, the oldest entry
+// is evicted.
+constexpr usize CHUNK_REVIVE_CACHE_SIZE = 512;
+
+struct ChunkReviveEntry {
+    b32 is_used;
+    v3i chunk_position;
+    // NOTE: Like in a chunk, NULL blocks means all the blocks are uniform_block.
+    ChunkBlocks* blocks;
+    u8 uniform_block;
+};
+
+struct ChunkReviveCache {
+    ChunkReviveEntry entries[CHUNK_REVIVE_CACHE_SIZE];
+    usize next_entry;
+    Hashmap<ChunkReviveEntry*, v3i, nextPowerOfTwo(CHUNK_REVIVE_CACHE_SIZE * 2), chunkPositionHash> hashmap;
+};
+
 struct GameState {
     f32 time;
     RandomSeries random_series;
-    SimplexTable simplex_table;
+    TerrainDescription terrain;
+    u32 terrain_preset_idx;
 
     Renderer renderer;
 
     f32 camera_pitch;
     f32 camera_yaw;
     v3 player_position;
+    v3 last_player_position;
+    v3 player_velocity;
     v3 camera_forward;
     b32 orbit_mode;
 
     WorldHashmap world_hashmap;
     Pool<Chunk, CHUNK_POOL_SIZE> chunk_pool;
+    ChunkList chunk_lists[CHUNK_LIST_COUNT];
+    // NOTE: Sized for the worst case where no chunk is uniform, plus the
+    // revive cache. Thanks to the LIFO free list, the slots we never need are
+    // never touched, so the OS doesn't have to back them with physical memory.
+    Pool<ChunkBlocks, CHUNK_POOL_SIZE + CHUNK_REVIVE_CACHE_SIZE> chunk_blocks_pool;
+    ChunkReviveCache chunk_revive_cache;
+    usize uniform_air_chunks_count;
+    usize uniform_solid_chunks_count;
+    // NOTE: Since the start, how many loaded chunks were classified from the
+    // terrain bounds, how many had their blocks generated, and how many were
+    // revived from the cache.
+    u64 classified_chunks_count;
+    u64 generated_chunks_count;
+    u64 revived_chunks_count;
+    usize skipped_meshings_count;
+    HeightmapCache heightmap_cache;
+
+    // NOTE: Streaming only does work when the player crosses into another
+    // chunk. The columns of the chunks entering the load sphere are queued,
+    // closest first, and loaded in the next frames as generation jobs free up.
+    ChunkSphereOffsets load_sphere;
+    ChunkSphereOffsets unload_sphere;
+    b32 has_streaming_center;
+    v3i streaming_center;
+    SPriorityQueue<ChunkColumnLoad, CHUNK_LOAD_QUEUE_SIZE> chunk_load_queue;
+    b32 has_prefetch_center;
+    v3i prefetch_center;
+    // NOTE: Since the start. A chunk entering the load sphere can already be
+    // loaded: prefetched if prefetching loaded it, retained if it was loaded
+    // before and never left the unload sphere. Only the first measures how
+    // well prefetching works.
+    u64 prefetched_chunks_count;
+    u64 cancelled_prefetches_count;
+    u64 entering_chunks_count;
+    u64 prefetched_entering_chunks_count;
+    u64 retained_entering_chunks_count;
+
+    Pool<ChunkGenerationJob, CHUNK_GENERATION_JOBS_COUNT> chunk_generation_jobs_pool;
+    ChunkGenerationCompletionQueue chunk_generation_completion_queue;
+    u64 last_integrated_chunks_count;
+    usize section_remeshes_count;
+    usize section_remesh_fallbacks_count;
+    f64 last_section_remesh_microseconds;
+    ChunkMesher chunk_mesher;
+    // NOTE: The LODs are relative to the player's chunk, so they are only
+    // picked again when the player crosses into another chunk, or when the
+    // LODs are toggled. The loaded chunks get theirs right away.
+    b32 is_lod_enabled;
+    b32 has_lod_center;
+    v3i lod_center;
+    usize lod_chunks_count[CHUNK_LOD_COUNT];
+    MeshingBenchmark meshing_benchmark;
+    TerrainBenchmark terrain_benchmark;
 
     VulkanPipeline chunk_render_pipeline;
     VulkanPipeline wireframe_render_pipeline;
+    AllocatedBuffer chunk_index_buffer;
 
     AllocatedBuffer view_matrix_uniforms[FRAMES_IN_FLIGHT];
     AllocatedBuffer projection_matrix_uniforms[FRAMES_IN_FLIGHT];
@@ -360,11 +612,796 @@ struct GameState {
     Arena frame_arena;
 };
 
+void markChunkForRemeshing(GameState* game_state, Chunk* chunk) {
+    chunk->needs_remeshing = true;
+    addChunkToList(&game_state->chunk_lists[CHUNK_LIST_DIRTY], CHUNK_LIST_DIRTY, chunk);
+}
+
+void markChunkSectionsDirty(GameState* game_state, Chunk* chunk, u8 sections) {
+    chunk->dirty_sections |= sections;
+    addChunkToList(&game_state->chunk_lists[CHUNK_LIST_DIRTY], CHUNK_LIST_DIRTY, chunk);
+}
+
+// NOTE: A chunk gets the LOD of the last ring it is outside of.
+u8 getChunkLod(GameState* game_state, v3i chunk_position) {
+    if (!game_state->is_lod_enabled) return 0;
+
+    u8 lod = 0;
+    for (u32 ring = 0; ring < CHUNK_LOD_COUNT - 1; ring++) {
+        if (!isInChunkSphere(game_state->lod_center, chunk_position, CHUNK_LOD_RING_RADII[ring])) lod = ring + 1;
+    }
+    return lod;
+}
+
+// NOTE: Picks the LOD of every chunk again, and remeshes the ones whose LOD
+// changed.
+void updateChunkLods(GameState* game_state, v3i player_chunk_pos) {
+    if (game_state->has_lod_center && game_state->lod_center == player_chunk_pos) return;
+    game_state->has_lod_center = true;
+    game_state->lod_center = player_chunk_pos;
+
+    for (u16 chunk_idx = 0; chunk_idx < game_state->chunk_pool.nb_allocated; chunk_idx++) {
+        Chunk* chunk = PoolGetAllocatedItem(&game_state->chunk_pool, chunk_idx);
+
+        u8 lod = getChunkLod(game_state, chunk->chunk_position);
+        if (chunk->lod == lod) continue;
+
+        game_state->lod_chunks_count[chunk->lod]--;
+        game_state->lod_chunks_count[lod]++;
+        chunk->lod = lod;
+        markChunkForRemeshing(game_state, chunk);
+    }
+}
+
+// NOTE: Removes a block, and marks as dirty the mesh sections that can see
+// it: its own section, the section above or below when the block is on their
+// boundary, and the sections of the neighbor chunks touching it.
+void removeBlock(GameState* game_state, v3i block_position) {
+    Chunk* chunk = hashmapGet(&game_state->world_hashmap, blockToChunkPos(block_position));
+    if (chunk == nullptr) return;
+
+    i32 local[3];
+    for (u32 axis = 0; axis < 3; axis++) {
+        local[axis] = block_position.data[axis] - chunk->chunk_position.data[axis] * CHUNK_W;
+    }
+    usize block_idx = local[0] + local[1] * CHUNK_W + local[2] * CHUNK_W * CHUNK_W;
+    if (getChunkBlock(chunk, block_idx) == 0) return;
+
+    // NOTE: A uniform chunk needs its own blocks before it can be edited.
+    if (chunk->blocks == nullptr) {
+        chunk->blocks = PoolAcquireItem(&game_state->chunk_blocks_pool);
+        for (usize i = 0; i < CHUNK_W * CHUNK_W * CHUNK_W; i++) {
+            chunk->blocks->data[i] = chunk->uniform_block;
+        }
+        game_state->uniform_solid_chunks_count--;
+    }
+    chunk->blocks->data[block_idx] = BLOCK_AIR;
+
+    // NOTE: In a coarse chunk, the block's cell can touch the sections above
+    // and below from anywhere in its section. Far edits are rare, so just
+    // dirty them all.
+    if (chunk->lod > 0) {
+        markChunkSectionsDirty(game_state, chunk, ALL_CHUNK_SECTIONS);
+    }
+
+    u32 section = local[1] / CHUNK_SECTION_H;
+    markChunkSectionsDirty(game_state, chunk, 1 << section);
+    if (local[1] % CHUNK_SECTION_H == 0 && section > 0) {
+        markChunkSectionsDirty(game_state, chunk, 1 << (section - 1));
+    }
+    if (local[1] % CHUNK_SECTION_H == CHUNK_SECTION_H - 1 && section < CHUNK_MESH_SECTIONS - 1) {
+        markChunkSectionsDirty(game_state, chunk, 1 << (section + 1));
+    }
+
+    for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+        u32 axis = direction / 2;
+        b32 is_positive = (direction % 2) == 0;
+        if (local[axis] != (is_positive ? CHUNK_W - 1 : 0)) continue;
+
+        v3i neighbor_position = chunk->chunk_position;
+        neighbor_position.data[axis] += is_positive ? 1 : -1;
+        Chunk* neighbor = hashmapGet(&game_state->world_hashmap, neighbor_position);
+        if (neighbor == nullptr) continue;
+
+        // NOTE: The chunks above and below only see the change in the
+        // section touching this chunk.
+        if (axis == 1) {
+            markChunkSectionsDirty(game_state, neighbor, 1 << (is_positive ? 0 : CHUNK_MESH_SECTIONS - 1));
+        } else {
+            markChunkSectionsDirty(game_state, neighbor, 1 << section);
+        }
+    }
+}
+
+void debugRunMeshingBenchmark(GameState* game_state) {
+    constexpr u32 REPETITIONS = 8;
+
+    MeshingBenchmark* benchmark = &game_state->meshing_benchmark;
+    *benchmark = {};
+
+    ChunkVertex* vertices = (ChunkVertex*)pushBytes(&game_state->frame_arena, MAX_CHUNK_VERTICES * sizeof(ChunkVertex));
+    ChunkFaceMasks* masks = pushStruct(&game_state->frame_arena, ChunkFaceMasks);
+    ChunkFaceTypes* types = pushStruct(&game_state->frame_arena, ChunkFaceTypes);
+    PaddedChunk* padded = pushStruct(&game_state->frame_arena, PaddedChunk);
+    usize generated_vertices;
+    ChunkMeshRanges ranges;
+
+    benchmark->chunks_count = game_state->chunk_pool.nb_allocated;
+    if (benchmark->chunks_count == 0) return;
+
+    // NOTE: Every path gets its own pass over all the chunks, so they
+    // all start in the same cache conditions.
+    for (u32 path_idx = 0; path_idx < MESHING_BENCHMARK_PATH_COUNT; path_idx++) {
+        MeshingBenchmarkPath path = (MeshingBenchmarkPath)path_idx;
+        i64 start = getWallClock();
+
+        for (u32 repetition = 0; repetition < REPETITIONS; repetition++) {
+            for (u16 chunk_idx = 0; chunk_idx < game_state->chunk_pool.nb_allocated; chunk_idx++) {
+                Chunk* chunk = PoolGetAllocatedItem(&game_state->chunk_pool, chunk_idx);
+
+                gatherPaddedChunk(&game_state->world_hashmap, chunk, padded);
+
+                switch (path) {
+                    case MESHING_BENCHMARK_GATHER: break;
+                    case MESHING_BENCHMARK_NAIVE: {
+                        for (u32 section = 0; section < CHUNK_MESH_SECTIONS; section++) {
+                            generateNaiveChunkMesh(padded, section, vertices, &generated_vertices, &ranges);
+                        }
+                    } break;
+                    case MESHING_BENCHMARK_FACE_MASKS: {
+                        buildChunkFaceMasks(padded, masks);
+                        buildChunkFaceTypes(padded, types);
+                    } break;
+                    case MESHING_BENCHMARK_BITMASK: {
+                        buildChunkFaceMasks(padded, masks);
+                        buildChunkFaceTypes(padded, types);
+                        generateBitmaskChunkMesh(masks, types, vertices, &generated_vertices, &ranges);
+                    } break;
+                    case MESHING_BENCHMARK_GREEDY: {
+                        buildChunkFaceMasks(padded, masks);
+                        buildChunkFaceTypes(padded, types);
+                        generateGreedyChunkMesh(masks, types, vertices, &generated_vertices, &ranges);
+                    } break;
+                    case MESHING_BENCHMARK_GREEDY_COUNT: {
+                        buildChunkFaceMasks(padded, masks);
+                        buildChunkFaceTypes(padded, types);
+                        generated_vertices = countGreedyChunkMeshVertices(masks, types, &ranges);
+                    } break;
+                    default: {
+                        ASSERT(false);
+                    } break;
+                }
+            }
+        }
+
+        benchmark->microseconds[path] = getSecondsElapsed(start, getWallClock()) * 1e6 / (f64)(benchmark->chunks_count * REPETITIONS);
+    }
+
+    benchmark->has_run = true;
+}
+
+void releaseChunkReviveEntry(GameState* game_state, ChunkReviveEntry* entry) {
+    ASSERT(entry->is_used);
+
+    if (entry->blocks) {
+        PoolReleaseItem(&game_state->chunk_blocks_pool, entry->blocks);
+    }
+    hashmapRemove(&game_state->chunk_revive_cache.hashmap, entry->chunk_position);
+    *entry = {};
+}
+
+// NOTE: Takes the blocks of a chunk being unloaded.
+void cacheUnloadedChunk(GameState* game_state, Chunk* chunk) {
+    ChunkReviveCache* cache = &game_state->chunk_revive_cache;
+
+    ChunkReviveEntry* entry = &cache->entries[cache->next_entry];
+    cache->next_entry = (cache->next_entry + 1) % CHUNK_REVIVE_CACHE_SIZE;
+    if (entry->is_used) {
+        releaseChunkReviveEntry(game_state, entry);
+    }
+
+    entry->is_used = true;
+    entry->chunk_position = chunk->chunk_position;
+    entry->blocks = chunk->blocks;
+    entry->uniform_block = chunk->uniform_block;
+    hashmapInsert(&cache->hashmap, chunk->chunk_position, entry);
+}
+
+// NOTE: When the whole world changes, the cached blocks are not valid anymore.
+void clearChunkReviveCache(GameState* game_state) {
+    ChunkReviveCache* cache = &game_state->chunk_revive_cache;
+    for (usize entry_idx = 0; entry_idx < CHUNK_REVIVE_CACHE_SIZE; entry_idx++) {
+        if (!cache->entries[entry_idx].is_used) continue;
+        releaseChunkReviveEntry(game_state, &cache->entries[entry_idx]);
+    }
+    cache->next_entry = 0;
+}
+
+void unloadChunk(GameState* game_state, Chunk* chunk) {
+    if (chunk->vertex_buffer.buffer != nullptr) {
+        graphicsMemoryFreeBuffer(&game_state->renderer.vram_allocator, &chunk->vertex_buffer);
+    }
+
+    if (chunk->blocks == nullptr) {
+        if (chunk->uniform_block) {
+            game_state->uniform_solid_chunks_count--;
+        } else {
+            game_state->uniform_air_chunks_count--;
+        }
+    }
+
+    // NOTE: The mesh is not kept: it depends on the neighbors, which change
+    // while the chunk is away, so a revived chunk is remeshed anyway.
+    cacheUnloadedChunk(game_state, chunk);
+
+    for (u32 kind = 0; kind < CHUNK_LIST_COUNT; kind++) {
+        removeChunkFromList(&game_state->chunk_lists[kind], (ChunkListKind)kind, chunk);
+    }
+    game_state->lod_chunks_count[chunk->lod]--;
+    chunk->is_loaded = false;
+
+    hashmapRemove(&game_state->world_hashmap, chunk->chunk_position);
+    PoolReleaseItem(&game_state->chunk_pool, chunk);
+}
+
+// NOTE: When adding a chunk, all it's neighbors already in the world need
+// remeshing since no block faces are created at the boundary with
+// not-yet-loaded chunks.
+void markChunkNeighborsForRemeshing(GameState* game_state, v3i chunk_position) {
+    for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+        v3i neighbor_position = chunk_position;
+        neighbor_position.data[direction / 2] += (direction % 2) == 0 ? 1 : -1;
+        Chunk* neighbor = hashmapGet(&game_state->world_hashmap, neighbor_position);
+        if (neighbor) {
+            markChunkForRemeshing(game_state, neighbor);
+        }
+    }
+}
+
+// NOTE: Runs on a worker thread. It only touches the job and the blocks it
+// was given, never the game state.
+void generateChunkColumnJob(void* data) {
+    ChunkGenerationJob* job = (ChunkGenerationJob*)data;
+
+    b32 is_heightmap = job->terrain.kind == TERRAIN_HEIGHTMAP;
+    if (is_heightmap && !job->has_cached_heightmap) {
+        generateTerrainHeightmap(&job->terrain, job->chunk_x, job->chunk_z, &job->heightmap);
+    }
+
+    for (u32 chunk_idx = 0; chunk_idx < job->chunks_count; chunk_idx++) {
+        i32 chunk_y = job->chunk_ys[chunk_idx];
+        ChunkBlocks* blocks = job->blocks[chunk_idx];
+
+        // NOTE: The heightmap wasn't known when the chunk was queued, it may
+        // classify it now.
+        if (is_heightmap) {
+            ChunkFill fill = classifyChunkFromHeightmap(&job->heightmap, chunk_y);
+            if (fill != CHUNK_FILL_MIXED) {
+                job->is_uniform[chunk_idx] = true;
+                job->uniform_blocks[chunk_idx] = fill == CHUNK_FILL_SOLID ? BLOCK_STONE : BLOCK_AIR;
+                continue;
+            }
+            fillChunkBlocksFromHeightmap(&job->heightmap, chunk_y, blocks);
+        } else {
+            generateChunkBlocks(&job->terrain, v3i {job->chunk_x, chunk_y, job->chunk_z}, blocks);
+        }
+
+        b32 is_uniform = true;
+        for (usize block_idx = 1; block_idx < CHUNK_W * CHUNK_W * CHUNK_W; block_idx++) {
+            if (blocks->data[block_idx] != blocks->data[0]) {
+                is_uniform = false;
+                break;
+            }
+        }
+        job->is_uniform[chunk_idx] = is_uniform;
+        job->uniform_blocks[chunk_idx] = blocks->data[0];
+    }
+
+    ChunkGenerationCompletionQueue* queue = job->completion_queue;
+    u32 entry_idx = atomicFetchAddU32(&queue->next_entry_to_write, 1) % CHUNK_GENERATION_JOBS_COUNT;
+    atomicStorePointerRelease(&queue->entries[entry_idx], job);
+}
+
+// NOTE: Puts the chunks the workers finished in the world, until the budget
+// is spent.
+void integrateGeneratedChunks(GameState* game_state, u64 chunks_budget) {
+    ChunkGenerationCompletionQueue* queue = &game_state->chunk_generation_completion_queue;
+
+    u64 integrated_chunks_count = 0;
+    while (integrated_chunks_count < chunks_budget) {
+        u32 entry_idx = queue->next_entry_to_read % CHUNK_GENERATION_JOBS_COUNT;
+        ChunkGenerationJob* job = atomicLoadPointerAcquire(&queue->entries[entry_idx]);
+        if (job == nullptr) break;
+        queue->entries[entry_idx] = nullptr;
+        queue->next_entry_to_read++;
+
+        if (job->terrain.kind == TERRAIN_HEIGHTMAP && !job->has_cached_heightmap) {
+            insertCachedChunkHeightmap(&game_state->heightmap_cache, job->chunk_x, job->chunk_z, &job->heightmap);
+        }
+
+        for (u32 chunk_idx = 0; chunk_idx < job->chunks_count; chunk_idx++) {
+            Chunk* chunk = job->chunks[chunk_idx];
+            ASSERT(chunk->is_loaded && chunk->is_generating);
+
+            if (job->is_uniform[chunk_idx]) {
+                PoolReleaseItem(&game_state->chunk_blocks_pool, job->blocks[chunk_idx]);
+                chunk->uniform_block = job->uniform_blocks[chunk_idx];
+                if (chunk->uniform_block) {
+                    game_state->uniform_solid_chunks_count++;
+                } else {
+                    game_state->uniform_air_chunks_count++;
+                }
+            } else {
+                chunk->blocks = job->blocks[chunk_idx];
+            }
+
+            chunk->is_generating = false;
+
+            // NOTE: The player may have moved away while it was generated.
+            // The prefetched chunks are unloaded when they are cancelled.
+            if (!isInChunkSphere(game_state->streaming_center, chunk->chunk_position, UNLOAD_RADIUS) &&
+                !chunk->list_positions[CHUNK_LIST_PREFETCHED]) {
+                unloadChunk(game_state, chunk);
+                continue;
+            }
+
+            markChunkForRemeshing(game_state, chunk);
+            markChunkNeighborsForRemeshing(game_state, chunk->chunk_position);
+        }
+
+        integrated_chunks_count += job->chunks_count;
+        PoolReleaseItem(&game_state->chunk_generation_jobs_pool, job);
+    }
+
+    game_state->last_integrated_chunks_count = integrated_chunks_count;
+}
+
+// NOTE: Waits for every queued job, and integrates all of them, for when
+// the whole world has to change at once.
+void finishChunkGeneration(GameState* game_state, GameMemory* memory) {
+    memory->platformCompleteAllWork(memory->work_queue);
+    integrateGeneratedChunks(game_state, UINT64_MAX);
+    ASSERT(game_state->chunk_generation_jobs_pool.nb_allocated == 0);
+}
+
+// NOTE: How soon a chunk should be streamed in, lower is sooner : its
+// distance to the player's chunk, counted up to twice as far when it is
+// behind the camera, so that the chunks in view appear first.
+f32 getChunkStreamingPriority(v3i center_chunk_pos, v3 camera_forward, v3i chunk_pos) {
+    v3 offset = v3 {
+        (f32)(chunk_pos.x() - center_chunk_pos.x()),
+        (f32)(chunk_pos.y() - center_chunk_pos.y()),
+        (f32)(chunk_pos.z() - center_chunk_pos.z())
+    };
+    f32 dist = length(offset);
+    if (dist == 0.0f) return 0.0f;
+
+    f32 facing = dot(offset, camera_forward) / dist;
+    return dist * (1.5f - 0.5f * facing);
+}
+
+// NOTE: A column is prioritized like its chunk at the height of the player.
+f32 getChunkColumnLoadPriority(GameState* game_state, ChunkColumnLoad load) {
+    v3i center = game_state->streaming_center;
+    f32 priority = getChunkStreamingPriority(center, game_state->camera_forward, v3i {load.column.x(), center.y(), load.column.y()});
+    return load.is_prefetch ? priority + CHUNK_PREFETCH_PRIORITY_OFFSET : priority;
+}
+
+void queueChunkColumnLoad(GameState* game_state, i32 x, i32 z, b32 is_prefetch) {
+    ChunkColumnLoad load = {};
+    load.column = v2i {x, z};
+    load.is_prefetch = is_prefetch;
+    game_state->chunk_load_queue.push(load, getChunkColumnLoadPriority(game_state, load));
+}
+
+// NOTE: The priorities are relative to the streaming center, so they are
+// recomputed when it moves. The columns that left their sphere are dropped.
+void reprioritizeChunkColumnLoads(GameState* game_state) {
+    SPriorityQueue<ChunkColumnLoad, CHUNK_LOAD_QUEUE_SIZE>* load_queue = &game_state->chunk_load_queue;
+    v3i center = game_state->streaming_center;
+
+    usize kept_count = 0;
+    for (usize entry_idx = 0; entry_idx < load_queue->count; entry_idx++) {
+        ChunkColumnLoad load = load_queue->data[entry_idx];
+        if (load.is_prefetch) {
+            if (!game_state->has_prefetch_center) continue;
+            v3i prefetch_center = game_state->prefetch_center;
+            if (!isInChunkSphere(prefetch_center, v3i {load.column.x(), prefetch_center.y(), load.column.y()}, LOAD_RADIUS)) continue;
+        } else {
+            if (!isInChunkSphere(center, v3i {load.column.x(), center.y(), load.column.y()}, LOAD_RADIUS)) continue;
+        }
+
+        load_queue->data[kept_count] = load;
+        load_queue->priorities[kept_count] = getChunkColumnLoadPriority(game_state, load);
+        kept_count++;
+    }
+    load_queue->count = kept_count;
+    load_queue->heapify();
+}
+
+// NOTE: Streams around a new center from scratch: unloads everything outside
+// of its unload sphere, and queues all the columns of its load sphere. Used at startup,
+// when the world is reset, and when the player moves too far at once for the
+// shells to be cheaper than that.
+void restartChunkStreaming(GameState* game_state, v3i center_chunk_pos) {
+    for (u16 chunk_idx = game_state->chunk_pool.nb_allocated; chunk_idx-- > 0;) {
+        Chunk* chunk = PoolGetAllocatedItem(&game_state->chunk_pool, chunk_idx);
+        if (chunk->is_generating) continue;
+        if (isInChunkSphere(center_chunk_pos, chunk->chunk_position, UNLOAD_RADIUS)) continue;
+        unloadChunk(game_state, chunk);
+    }
+
+    game_state->streaming_center = center_chunk_pos;
+    game_state->has_streaming_center = true;
+
+    // NOTE: The offsets of a column are next to each other in the sphere.
+    game_state->chunk_load_queue.clear();
+    ChunkSphereOffsets* load_sphere = &game_state->load_sphere;
+    for (usize offset_idx = 0; offset_idx < load_sphere->sphere_count; offset_idx++) {
+        v3i offset = load_sphere->sphere[offset_idx];
+        if (offset_idx > 0) {
+            v3i previous_offset = load_sphere->sphere[offset_idx - 1];
+            if (previous_offset.x() == offset.x() && previous_offset.z() == offset.z()) continue;
+        }
+        queueChunkColumnLoad(game_state, center_chunk_pos.x() + offset.x(), center_chunk_pos.z() + offset.z(), false);
+    }
+
+    // NOTE: The prefetch columns were dropped with the rest of the queue.
+    game_state->has_prefetch_center = false;
+}
+
+// NOTE: Moves the streaming center to the player's chunk one step at a time.
+// Each step only looks at the shells of the spheres: the chunks leaving the
+// unload sphere are unloaded and the ones entering the load sphere are
+// queued. The chunks leaving are tested against the final center, so a chunk
+// that a later step brings back in is never unloaded. The chunks still being generated
+// are unloaded when they are integrated.
+void updateChunkStreaming(GameState* game_state, v3i player_chunk_pos) {
+    if (!game_state->has_streaming_center) {
+        restartChunkStreaming(game_state, player_chunk_pos);
+        return;
+    }
+
+    v3i delta = player_chunk_pos - game_state->streaming_center;
+    if (delta == v3i {}) return;
+
+    i64 steps_count = 0;
+    for (u32 axis = 0; axis < 3; axis++) {
+        steps_count += delta.data[axis] < 0 ? -(i64)delta.data[axis] : delta.data[axis];
+    }
+    if (steps_count > LOAD_RADIUS ||
+        (usize)steps_count * CHUNK_SHELL_MAX_OFFSETS > game_state->chunk_load_queue.free_count()) {
+        restartChunkStreaming(game_state, player_chunk_pos);
+        return;
+    }
+
+    ChunkSphereOffsets* load_sphere = &game_state->load_sphere;
+    ChunkSphereOffsets* unload_sphere = &game_state->unload_sphere;
+    v3i center = game_state->streaming_center;
+    game_state->streaming_center = player_chunk_pos;
+
+    for (u32 axis = 0; axis < 3; axis++) {
+        while (center.data[axis] != player_chunk_pos.data[axis]) {
+            b32 is_positive = center.data[axis] < player_chunk_pos.data[axis];
+            u32 direction = axis * 2 + (is_positive ? 0 : 1);
+            u32 opposite_direction = axis * 2 + (is_positive ? 1 : 0);
+
+            for (usize offset_idx = 0; offset_idx < unload_sphere->shells_count[opposite_direction]; offset_idx++) {
+                v3i chunk_pos = center + unload_sphere->shells[opposite_direction][offset_idx];
+                if (isInChunkSphere(player_chunk_pos, chunk_pos, UNLOAD_RADIUS)) continue;
+
+                // NOTE: The prefetched chunks are unloaded when they are cancelled.
+                Chunk* chunk = hashmapGet(&game_state->world_hashmap, chunk_pos);
+                if (chunk == nullptr || chunk->is_generating) continue;
+                if (chunk->list_positions[CHUNK_LIST_PREFETCHED]) continue;
+                unloadChunk(game_state, chunk);
+            }
+
+            center.data[axis] += is_positive ? 1 : -1;
+
+            // NOTE: The column jobs load every missing chunk of their column,
+            // so a column is only queued once per step.
+            v3i previous_chunk_pos = {};
+            b32 has_queued_column = false;
+            for (usize offset_idx = 0; offset_idx < load_sphere->shells_count[direction]; offset_idx++) {
+                v3i chunk_pos = center + load_sphere->shells[direction][offset_idx];
+                if (!isInChunkSphere(player_chunk_pos, chunk_pos, LOAD_RADIUS)) continue;
+
+                Chunk* entering_chunk = hashmapGet(&game_state->world_hashmap, chunk_pos);
+                game_state->entering_chunks_count++;
+                if (entering_chunk && !entering_chunk->is_generating) {
+                    if (entering_chunk->is_prefetched) {
+                        game_state->prefetched_entering_chunks_count++;
+                    } else {
+                        game_state->retained_entering_chunks_count++;
+                    }
+                }
+                if (entering_chunk) {
+                    entering_chunk->is_prefetched = false;
+                }
+
+                if (has_queued_column && previous_chunk_pos.x() == chunk_pos.x() && previous_chunk_pos.z() == chunk_pos.z()) continue;
+
+                queueChunkColumnLoad(game_state, chunk_pos.x(), chunk_pos.z(), false);
+                previous_chunk_pos = chunk_pos;
+                has_queued_column = true;
+            }
+        }
+    }
+
+    reprioritizeChunkColumnLoads(game_state);
+}
+
+// NOTE: Predicts the player's chunk from their velocity, queues the columns
+// of its load sphere that reach out of the current one, and cancels the
+// prefetched chunks that are not around the prediction anymore. When the
+// player moves roughly where they look, the prediction follows the camera
+// right away instead of waiting for the smoothed velocity to turn.
+void updateChunkPrefetch(GameState* game_state) {
+    v3 velocity = game_state->player_velocity;
+    f32 speed = length(velocity);
+    if (speed > 0.0f && dot(velocity, game_state->camera_forward) > 0.5f * speed) {
+        velocity = game_state->camera_forward * speed;
+    }
+
+    v3i center = game_state->streaming_center;
+    v3i predicted_chunk_pos = worldPosToChunk(game_state->player_position + velocity * CHUNK_PREFETCH_SECONDS);
+    for (u32 axis = 0; axis < 3; axis++) {
+        i32 offset = predicted_chunk_pos.data[axis] - center.data[axis];
+        if (offset > LOAD_RADIUS) offset = LOAD_RADIUS;
+        if (offset < -LOAD_RADIUS) offset = -LOAD_RADIUS;
+        predicted_chunk_pos.data[axis] = center.data[axis] + offset;
+    }
+    b32 is_predicting = !(predicted_chunk_pos == center);
+
+    // NOTE: Walked backwards since chunks leave the list. The ones being
+    // generated are unloaded when they are integrated.
+    ChunkList* prefetched_chunks = &game_state->chunk_lists[CHUNK_LIST_PREFETCHED];
+    for (usize prefetched_idx = prefetched_chunks->count; prefetched_idx-- > 0;) {
+        Chunk* chunk = prefetched_chunks->chunks[prefetched_idx];
+
+        if (isInChunkSphere(center, chunk->chunk_position, UNLOAD_RADIUS)) {
+            removeChunkFromList(prefetched_chunks, CHUNK_LIST_PREFETCHED, chunk);
+            continue;
+        }
+
+        if (is_predicting && isInChunkSphere(predicted_chunk_pos, chunk->chunk_position, LOAD_RADIUS)) continue;
+
+        game_state->cancelled_prefetches_count++;
+        if (chunk->is_generating) {
+            removeChunkFromList(prefetched_chunks, CHUNK_LIST_PREFETCHED, chunk);
+        } else {
+            unloadChunk(game_state, chunk);
+        }
+    }
+
+    if (!is_predicting) {
+        game_state->has_prefetch_center = false;
+        return;
+    }
+    if (game_state->has_prefetch_center && game_state->prefetch_center == predicted_chunk_pos) return;
+
+    game_state->has_prefetch_center = true;
+    game_state->prefetch_center = predicted_chunk_pos;
+    reprioritizeChunkColumnLoads(game_state);
+
+    // NOTE: The offsets of a column go from its lowest chunk to its highest,
+    // and the column is already covered if both are in the load sphere.
+    ChunkSphereOffsets* load_sphere = &game_state->load_sphere;
+    if (game_state->chunk_load_queue.free_count() < CHUNK_SHELL_MAX_OFFSETS) return;
+
+    usize column_start_idx = 0;
+    for (usize offset_idx = 0; offset_idx < load_sphere->sphere_count; offset_idx++) {
+        v3i offset = load_sphere->sphere[offset_idx];
+        if (offset_idx + 1 < load_sphere->sphere_count) {
+            v3i next_offset = load_sphere->sphere[offset_idx + 1];
+            if (next_offset.x() == offset.x() && next_offset.z() == offset.z()) continue;
+        }
+
+        v3i column_bottom = predicted_chunk_pos + load_sphere->sphere[column_start_idx];
+        v3i column_top = predicted_chunk_pos + offset;
+        column_start_idx = offset_idx + 1;
+
+        if (isInChunkSphere(center, column_bottom, LOAD_RADIUS) && isInChunkSphere(center, column_top, LOAD_RADIUS)) continue;
+        queueChunkColumnLoad(game_state, column_top.x(), column_top.z(), true);
+    }
+}
+
+// NOTE: Loads the queued columns, closest first, one generation job per
+// column, until the time budget is spent. A column job loads every chunk of
+// the column that is in its sphere and not loaded yet, so it doesn't matter
+// if the column was queued twice or got loaded since.
+void loadQueuedChunks(GameState* game_state, GameMemory* memory) {
+    SPriorityQueue<ChunkColumnLoad, CHUNK_LOAD_QUEUE_SIZE>* load_queue = &game_state->chunk_load_queue;
+    v3i center = game_state->streaming_center;
+    i64 budget_start = getWallClock();
+
+    while (!load_queue->is_empty()) {
+        // NOTE: The column may need a job, wait for one to be free.
+        if (game_state->chunk_generation_jobs_pool.nb_allocated == CHUNK_GENERATION_JOBS_COUNT) break;
+        if (getSecondsElapsed(budget_start, getWallClock()) * 1e6 > CHUNK_LOAD_BUDGET_MICROSECONDS) break;
+
+        ChunkColumnLoad load = load_queue->pop();
+        i32 x = load.column.x();
+        i32 z = load.column.y();
+
+        if (load.is_prefetch && !game_state->has_prefetch_center) continue;
+        v3i sphere_center = load.is_prefetch ? game_state->prefetch_center : center;
+
+        ChunkGenerationJob* job = nullptr;
+        b32 has_looked_up_heightmap = false;
+        ChunkHeightmap* cached_heightmap = nullptr;
+
+        for (i32 y = sphere_center.y() - LOAD_RADIUS; y <= sphere_center.y() + LOAD_RADIUS; y++) {
+            v3i chunk_to_load_pos = v3i {x, y, z};
+
+            if (!isInChunkSphere(sphere_center, chunk_to_load_pos, LOAD_RADIUS)) continue;
+            if (hashmapContains(&game_state->world_hashmap, chunk_to_load_pos)) continue;
+
+            // NOTE: A prefetch column may also have chunks inside the load
+            // sphere, those are loaded as usual.
+            b32 is_prefetched = !isInChunkSphere(center, chunk_to_load_pos, LOAD_RADIUS);
+            if (is_prefetched && game_state->chunk_lists[CHUNK_LIST_PREFETCHED].count == CHUNK_PREFETCH_MAX_CHUNKS) continue;
+
+            // NOTE: Now we know that we need to load a new chunk.
+            Chunk* new_chunk = PoolAcquireItem(&game_state->chunk_pool);
+            hashmapInsert(&game_state->world_hashmap, chunk_to_load_pos, new_chunk);
+
+            // NOTE: Someone forgot to free VRAM...
+            ASSERT(new_chunk->vertex_buffer.buffer == nullptr);
+
+            *new_chunk = {};
+            new_chunk->is_loaded = true;
+            new_chunk->chunk_position = chunk_to_load_pos;
+            new_chunk->lod = getChunkLod(game_state, chunk_to_load_pos);
+            game_state->lod_chunks_count[new_chunk->lod]++;
+
+            // NOTE: A prefetched chunk inside the unload sphere is already a
+            // regular one.
+            if (is_prefetched && !isInChunkSphere(center, chunk_to_load_pos, UNLOAD_RADIUS)) {
+                addChunkToList(&game_state->chunk_lists[CHUNK_LIST_PREFETCHED], CHUNK_LIST_PREFETCHED, new_chunk);
+            }
+            if (is_prefetched) {
+                new_chunk->is_prefetched = true;
+                game_state->prefetched_chunks_count++;
+            }
+
+            // NOTE: A chunk unloaded recently gets its blocks back as is.
+            ChunkReviveEntry* revive_entry = hashmapGet(&game_state->chunk_revive_cache.hashmap, chunk_to_load_pos);
+            if (revive_entry) {
+                game_state->revived_chunks_count++;
+
+                new_chunk->blocks = revive_entry->blocks;
+                new_chunk->uniform_block = revive_entry->uniform_block;
+                if (new_chunk->blocks == nullptr) {
+                    if (new_chunk->uniform_block) {
+                        game_state->uniform_solid_chunks_count++;
+                    } else {
+                        game_state->uniform_air_chunks_count++;
+                    }
+                }
+
+                // NOTE: The blocks belong to the chunk now.
+                revive_entry->blocks = nullptr;
+                releaseChunkReviveEntry(game_state, revive_entry);
+
+                markChunkForRemeshing(game_state, new_chunk);
+                markChunkNeighborsForRemeshing(game_state, chunk_to_load_pos);
+                continue;
+            }
+
+            // NOTE: Chunks that are provably all air or all solid are
+            // classified from the terrain bounds, and then from the
+            // heightmap range of their column if it is cached, without
+            // any per-block work.
+            ChunkFill fill = classifyChunkFromTerrainBounds(&game_state->terrain, chunk_to_load_pos.y());
+            if (fill == CHUNK_FILL_MIXED && game_state->terrain.kind == TERRAIN_HEIGHTMAP) {
+                if (!has_looked_up_heightmap) {
+                    cached_heightmap = findCachedChunkHeightmap(&game_state->heightmap_cache, x, z);
+                    has_looked_up_heightmap = true;
+                }
+                if (cached_heightmap) {
+                    fill = classifyChunkFromHeightmap(cached_heightmap, chunk_to_load_pos.y());
+                }
+            }
+
+            if (fill != CHUNK_FILL_MIXED) {
+                game_state->classified_chunks_count++;
+
+                new_chunk->uniform_block = fill == CHUNK_FILL_SOLID ? BLOCK_STONE : BLOCK_AIR;
+                if (new_chunk->uniform_block) {
+                    game_state->uniform_solid_chunks_count++;
+                } else {
+                    game_state->uniform_air_chunks_count++;
+                }
+
+                markChunkForRemeshing(game_state, new_chunk);
+                markChunkNeighborsForRemeshing(game_state, chunk_to_load_pos);
+                continue;
+            }
+
+            game_state->generated_chunks_count++;
+
+            if (job == nullptr) {
+                job = PoolAcquireItem(&game_state->chunk_generation_jobs_pool);
+                *job = {};
+                job->terrain = game_state->terrain;
+                job->chunk_x = x;
+                job->chunk_z = z;
+                if (cached_heightmap) {
+                    job->has_cached_heightmap = true;
+                    job->heightmap = *cached_heightmap;
+                }
+                job->completion_queue = &game_state->chunk_generation_completion_queue;
+            }
+
+            // NOTE: The worker writes the blocks, the chunk only gets
+            // them (or becomes uniform) when the job is integrated.
+            ASSERT(job->chunks_count < CHUNK_GENERATION_COLUMN_H);
+            new_chunk->is_generating = true;
+            job->chunk_ys[job->chunks_count] = chunk_to_load_pos.y();
+            job->chunks[job->chunks_count] = new_chunk;
+            job->blocks[job->chunks_count] = PoolAcquireItem(&game_state->chunk_blocks_pool);
+            job->chunks_count++;
+        }
+
+        if (job) {
+            memory->platformAddWorkEntry(memory->work_queue, generateChunkColumnJob, job);
+        }
+    }
+}
+
+void debugRunTerrainBenchmark(GameState* game_state) {
+    constexpr i32 CHUNKS_W = 4;
+
+    TerrainBenchmark* benchmark = &game_state->terrain_benchmark;
+    *benchmark = {};
+
+    ChunkBlocks* blocks = pushStruct(&game_state->frame_arena, ChunkBlocks);
+
+    // NOTE: Away from the world horizontally, and around the surface
+    // vertically so that the chunks are not trivially empty or full. The
+    // offset stays well below 2^24 blocks, past which floats can't represent
+    // every block coordinate and the noise would be sampled at merged
+    // positions. The far away precision is checked by the terrain golden test.
+    constexpr i32 CHUNKS_OFFSET = 1 << 12;
+
+    for (u32 preset_idx = 0; preset_idx < TERRAIN_PRESETS_COUNT; preset_idx++) {
+        TerrainDescription preset = *TERRAIN_PRESETS[preset_idx];
+
+        i64 start = getWallClock();
+        for (i32 x = 0; x < CHUNKS_W; x++) {
+            for (i32 y = 0; y < CHUNKS_W; y++) {
+                for (i32 z = 0; z < CHUNKS_W; z++) {
+                    generateChunkBlocks(&preset, v3i {CHUNKS_OFFSET + x, y - CHUNKS_W / 2 + 1, CHUNKS_OFFSET + z}, blocks);
+                }
+            }
+        }
+        f64 seconds = getSecondsElapsed(start, getWallClock());
+
+        f64 voxels_count = (f64)(CHUNKS_W * CHUNKS_W * CHUNKS_W) * (f64)(CHUNK_W * CHUNK_W * CHUNK_W);
+        benchmark->mvoxels_per_second[preset_idx] = voxels_count / seconds / 1e6;
+    }
+
+    benchmark->has_run = true;
+}
+
+// NOTE: The globals of the game code are reset when it is reloaded, unlike
+// the game state.
+global b32 is_game_code_initialized = false;
+
 extern "C"
 void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, InputState* input) {
     ASSERT(memory->permanent_storage_size >= sizeof(GameState));
     GameState* game_state = (GameState*)memory->permanent_storage;
 
+    // NOTE: Once per load of the game code. The platform waits for the
+    // workers before reloading it, so no job is running yet.
+    if (!is_game_code_initialized) {
+        simplex_noise_init_dispatch();
+        is_game_code_initialized = true;
+    }
+
     // INITIALIZATION
     if(!memory->is_initialized) {
         game_state->static_arena.base = game_state->static_arena_memory;
@@ -388,12 +1425,13 @@ void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, I
         );
 
         game_state->player_position = {110, 40, 110};
+        game_state->last_player_position = game_state->player_position;
         game_state->orbit_mode = false;
         game_state->time = 0;
         game_state->camera_pitch = -1 * PI32 / 6;
         game_state->camera_yaw = 1 * PI32 / 3;
         game_state->random_series = 0xC0FFEE; // fixed seed for now
-        simplex_table_from_seed(&game_state->simplex_table, 0xC0FFEE);
+        game_state->terrain = TERRAIN_PRESET_HILLS;
 
         chunkPipelineInitialize(&game_state->renderer, &game_state->chunk_render_pipeline, &game_state->frame_arena);
         wireframePipelineInitialize(&game_state->renderer, &game_state->wireframe_render_pipeline, &game_state->frame_arena);
@@ -440,6 +1478,12 @@ void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, I
         }
 
         poolInitialize(&game_state->chunk_pool);
+        poolInitialize(&game_state->chunk_blocks_pool);
+        poolInitialize(&game_state->chunk_generation_jobs_pool);
+        game_state->chunk_mesher = CHUNK_MESHER_GREEDY;
+        game_state->is_lod_enabled = true;
+        buildChunkSphereOffsets(LOAD_RADIUS, &game_state->load_sphere);
+        buildChunkSphereOffsets(UNLOAD_RADIUS, &game_state->unload_sphere);
 
         memory->is_initialized = true;
     }
@@ -497,6 +1541,13 @@ void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, I
     game_state->player_position += input->ctrl.left_stick.x() * camera_right * speed;
     game_state->player_position += input->ctrl.left_stick.y() * game_state->camera_forward * speed;
 
+    // NOTE: Smoothed over a few frames, for the chunk prefetching.
+    if (dt > 0.0f) {
+        v3 frame_velocity = (game_state->player_position - game_state->last_player_position) * (1.0f / dt);
+        game_state->player_velocity += (frame_velocity - game_state->player_velocity) * PLAYER_VELOCITY_SMOOTHING;
+    }
+    game_state->last_player_position = game_state->player_position;
+
     if (input->kb.keys[SCANCODE_G].is_down && input->kb.keys[SCANCODE_G].transitions == 1) {
         game_state->is_wireframe = !game_state->is_wireframe;
     }
@@ -505,119 +1556,62 @@ void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, I
         game_state->orbit_mode = !game_state->orbit_mode;
     }
 
-    // NOTE: Unload chunks too far from the player.
-    for (usize chunk_idx = 0; chunk_idx < CHUNK_POOL_SIZE; chunk_idx++) {
-        Chunk* chunk = &game_state->chunk_pool.slots[chunk_idx];
-        if (!chunk->is_loaded) continue;
+    if (input->kb.keys[SCANCODE_B].is_down && input->kb.keys[SCANCODE_B].transitions == 1) {
+        debugRunMeshingBenchmark(game_state);
+        debugRunTerrainBenchmark(game_state);
+    }
 
-        v3 chunk_to_unload_world_pos = chunkToWorldPos(chunk->chunk_position);
-        v3 chunk_to_unload_center_pos = chunk_to_unload_world_pos + v3 {(f32)CHUNK_W / 2, (f32)CHUNK_W / 2, (f32)CHUNK_W / 2};
+    if (input->kb.keys[SCANCODE_SPACE].is_down && input->kb.keys[SCANCODE_SPACE].transitions == 1) {
+        v3i block_position;
+        if (raycastSolidBlock(&game_state->world_hashmap, game_state->player_position, game_state->camera_forward, 64.f, &block_position)) {
+            removeBlock(game_state, block_position);
+        }
+    }
 
-        v3 player_chunk_center_pos = chunkToWorldPos(worldPosToChunk(game_state->player_position)) + v3 {(f32)CHUNK_W / 2, (f32)CHUNK_W / 2, (f32)CHUNK_W / 2};
+    if (input->kb.keys[SCANCODE_L].is_down && input->kb.keys[SCANCODE_L].transitions == 1) {
+        game_state->is_lod_enabled = !game_state->is_lod_enabled;
+        game_state->has_lod_center = false;
+    }
 
-        // TODO: Maybe the unload distance should be greater than the load distance,
-        // so that if the player goes one direction and then walks back, we didn't
-        // have to unload and then load the chunk immediately after.
-        f32 dist = length(player_chunk_center_pos - chunk_to_unload_center_pos);
-        if (dist > (f32)LOAD_RADIUS * CHUNK_W) {
+    // NOTE: Switch to the next mesher, and remesh the whole world with it.
+    if (input->kb.keys[SCANCODE_M].is_down && input->kb.keys[SCANCODE_M].transitions == 1) {
+        game_state->chunk_mesher = (ChunkMesher)((game_state->chunk_mesher + 1) % CHUNK_MESHER_COUNT);
 
-            if (chunk->vertex_buffer.buffer != nullptr) {
-                graphicsMemoryFreeBuffer(&game_state->renderer.vram_allocator, &chunk->vertex_buffer);
-            }
-
-            hashmapRemove(&game_state->world_hashmap, chunk->chunk_position);
-            PoolReleaseItem(&game_state->chunk_pool, chunk);
+        for (u16 chunk_idx = 0; chunk_idx < game_state->chunk_pool.nb_allocated; chunk_idx++) {
+            markChunkForRemeshing(game_state, PoolGetAllocatedItem(&game_state->chunk_pool, chunk_idx));
         }
     }
 
-    // NOTE: Iterate over all chunk positions that should be loaded, and
-    // load them if they aren't.
-    v3i player_chunk_pos = worldPosToChunk(game_state->player_position);
-    for (i32 x = player_chunk_pos.x() - LOAD_RADIUS; x <= player_chunk_pos.x() + LOAD_RADIUS; x++) {
-        for (i32 y = player_chunk_pos.y() - LOAD_RADIUS; y <= player_chunk_pos.y() + LOAD_RADIUS; y++) {
-            for (i32 z = player_chunk_pos.z() - LOAD_RADIUS; z <= player_chunk_pos.z() + LOAD_RADIUS; z++) {
-
-                v3i chunk_to_load_pos = v3i {x, y, z};
-
-                v3 chunk_to_load_world_pos = chunkToWorldPos(chunk_to_load_pos);
-                v3 chunk_to_load_center_pos = chunk_to_load_world_pos + v3 {(f32)CHUNK_W / 2, (f32)CHUNK_W / 2, (f32)CHUNK_W / 2};
-
-                v3 player_chunk_center_pos = chunkToWorldPos(worldPosToChunk(game_state->player_position)) + v3 {(f32)CHUNK_W / 2, (f32)CHUNK_W / 2, (f32)CHUNK_W / 2};
-
-                if (length(player_chunk_center_pos - chunk_to_load_center_pos) > (f32)LOAD_RADIUS * CHUNK_W) continue;
-                if (hashmapContains(&game_state->world_hashmap, chunk_to_load_pos)) continue;
-
-                // NOTE: Now we know that we need to load a new chunk.
-                Chunk* new_chunk = PoolAcquireItem(&game_state->chunk_pool);
-                hashmapInsert(&game_state->world_hashmap, chunk_to_load_pos, new_chunk);
-
-                // NOTE: Someone forgot to free VRAM...
-                ASSERT(new_chunk->vertex_buffer.buffer == nullptr);
-
-                *new_chunk = {};
-                new_chunk->is_loaded = true;
-                new_chunk->chunk_position = chunk_to_load_pos;
-                new_chunk->needs_remeshing = true;
-
-                for(usize block_idx = 0; block_idx < CHUNK_W * CHUNK_W * CHUNK_W; block_idx++){
-                    i64 block_x = (i64)new_chunk->chunk_position.x() * CHUNK_W + (block_idx % CHUNK_W);
-                    i64 block_y = (i64)new_chunk->chunk_position.y() * CHUNK_W + (block_idx / CHUNK_W) % (CHUNK_W);
-                    i64 block_z = (i64)new_chunk->chunk_position.z() * CHUNK_W + (block_idx / (CHUNK_W * CHUNK_W));
-
-                    // TODO: This needs to be parameterized and put into a function.
-                    // The fancy name is "fractal brownian motion", but it's just summing
-                    // noise layers with reducing intensity and increasing frequency.
-                    f32 space_scaling_factor = 0.01;
-                    f32 height_intensity = 32.0;
-                    f32 height = 0;
-                    for (i32 octave = 0; octave < 5; octave ++) {
-                        height += ((simplex_noise_2d(&game_state->simplex_table, (f32)block_x * space_scaling_factor, (f32) block_z * space_scaling_factor) + 1.f) / 2.f) * height_intensity;
-                        space_scaling_factor *= 2.f;
-                        height_intensity /= 3.f;
-                    }
+    // NOTE: Switch to the next terrain preset, and regenerate the whole world
+    // with it.
+    if (input->kb.keys[SCANCODE_T].is_down && input->kb.keys[SCANCODE_T].transitions == 1) {
+        game_state->terrain_preset_idx = (game_state->terrain_preset_idx + 1) % TERRAIN_PRESETS_COUNT;
+        game_state->terrain = *TERRAIN_PRESETS[game_state->terrain_preset_idx];
 
-                    if (block_y <= height) {
-                        new_chunk->data[block_idx] = 1;
-                    } else {
-                        // TODO: We cleared the whole chunk
-                        // memory a dozen lines up, but should we ?
-                        // Or would it be better to define precise
-                        // chunk memory lifetimes so we know when
-                        // it has or has not been cleared ?
-                        // new_chunk->data[block_idx] = 0;
-                    }
-                }
+        // NOTE: The chunks being generated can't be unloaded.
+        finishChunkGeneration(game_state, memory);
+        clearHeightmapCache(&game_state->heightmap_cache);
 
-                // NOTE: When adding a chunk, all it's neighbors already in the
-                // world need remeshing since no block faces are created at the
-                // boundary with not-yet-loaded chunks.
-                Chunk* pos_x_neighbor = hashmapGet(&game_state->world_hashmap, chunk_to_load_pos + v3i {1, 0, 0});
-                if (pos_x_neighbor) {
-                    pos_x_neighbor->needs_remeshing = true;
-                }
-                Chunk* neg_x_neighbor = hashmapGet(&game_state->world_hashmap, chunk_to_load_pos - v3i {1, 0, 0});
-                if (neg_x_neighbor) {
-                    neg_x_neighbor->needs_remeshing = true;
-                }
-                Chunk* pos_y_neighbor = hashmapGet(&game_state->world_hashmap, chunk_to_load_pos + v3i {0, 1, 0});
-                if (pos_y_neighbor) {
-                    pos_y_neighbor->needs_remeshing = true;
-                }
-                Chunk* neg_y_neighbor = hashmapGet(&game_state->world_hashmap, chunk_to_load_pos - v3i {0, 1, 0});
-                if (neg_y_neighbor) {
-                    neg_y_neighbor->needs_remeshing = true;
-                }
-                Chunk* pos_z_neighbor = hashmapGet(&game_state->world_hashmap, chunk_to_load_pos + v3i {0, 0, 1});
-                if (pos_z_neighbor) {
-                    pos_z_neighbor->needs_remeshing = true;
-                }
-                Chunk* neg_z_neighbor = hashmapGet(&game_state->world_hashmap, chunk_to_load_pos - v3i {0, 0, 1});
-                if (neg_z_neighbor) {
-                    neg_z_neighbor->needs_remeshing = true;
-                }
-            }
+        while (game_state->chunk_pool.nb_allocated > 0) {
+            unloadChunk(game_state, PoolGetAllocatedItem(&game_state->chunk_pool, game_state->chunk_pool.nb_allocated - 1));
         }
+        clearChunkReviveCache(game_state);
+        game_state->has_streaming_center = false;
+        game_state->has_prefetch_center = false;
     }
+
+    // NOTE: Unload the chunks leaving the load sphere and queue the ones
+    // entering it, only when the player crosses into another chunk.
+    v3i player_chunk_pos = worldPosToChunk(game_state->player_position);
+    updateChunkStreaming(game_state, player_chunk_pos);
+    updateChunkPrefetch(game_state);
+    updateChunkLods(game_state, player_chunk_pos);
+
+    // NOTE: Put the chunks generated since the last frame in the world.
+    integrateGeneratedChunks(game_state, CHUNK_INTEGRATION_BUDGET);
+
+    loadQueuedChunks(game_state, memory);
+
     // RENDERING
 
     // NOTE: Handle swapchain resizing.
@@ -638,7 +1632,7 @@ void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, I
     ASSERT(acquire_err == VK_SUCCESS);
 
     // TODO: This needs to be put somewhere else.
-    game_state->renderer.distributed_staging_buffers = 0;
+    rendererResetStagingMemory(&game_state->renderer);
 
     // NOTE: Begin using the command buffer, specifying that we will only be
     // submitting once before resetting it (because the render commands needed
@@ -666,46 +1660,165 @@ void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, I
         );
     }
 
-    // NOTE: Iterate on all chunks from the pool and record copy commands
-    // for every chunk from that pool that needs its mesh buffer updated.
-    for (u32 chunk_idx = 0; chunk_idx < CHUNK_POOL_SIZE; chunk_idx++) {
-        Chunk* chunk = &game_state->chunk_pool.slots[chunk_idx];
-        if (!chunk->is_loaded) continue;
-        if (!chunk->needs_remeshing) continue;
+    if (game_state->chunk_index_buffer.buffer == nullptr) {
+        chunkIndexBufferInitialize(&game_state->renderer, &game_state->chunk_index_buffer, current_frame.cmd_buffer);
+    }
 
-        AllocatedBuffer* staging_buffer = rendererRequestStagingBuffer(&game_state->renderer);
-        // NOTE: No more staging buffers available !
-        // The remaining chunks will have to wait for the next frame.
-        if (staging_buffer == nullptr) break;
+    // NOTE: The naive mesher is our reference in slow builds. It needs
+    // its own buffer, since the staging memory is sized for the mesh of
+    // the selected mesher only.
+    #if ENGINE_SLOW
+    ChunkVertex* reference_vertices = (ChunkVertex*)pushBytes(&game_state->frame_arena, MAX_CHUNK_VERTICES * sizeof(ChunkVertex));
+    #endif
+
+    // NOTE: Record copy commands for the dirty chunks that need their mesh
+    // buffer updated, closest first, until the time budget is spent. A chunk
+    // leaves the dirty list once it is remeshed.
+    ChunkList* dirty_chunks = &game_state->chunk_lists[CHUNK_LIST_DIRTY];
+    ChunkList* visible_chunks = &game_state->chunk_lists[CHUNK_LIST_VISIBLE];
+    ChunkRemeshQueue* remesh_queue = pushStruct(&game_state->frame_arena, ChunkRemeshQueue);
+    remesh_queue->clear();
+    for (usize dirty_idx = 0; dirty_idx < dirty_chunks->count; dirty_idx++) {
+        Chunk* chunk = dirty_chunks->chunks[dirty_idx];
+        ASSERT(chunk->is_loaded);
+        ASSERT(chunk->needs_remeshing || chunk->dirty_sections);
+        if (chunk->is_generating) continue;
+
+        f32 priority = getChunkStreamingPriority(player_chunk_pos, game_state->camera_forward, chunk->chunk_position);
+        remesh_queue->push(chunk, priority);
+    }
+
+    i64 remesh_budget_start = getWallClock();
+    while (!remesh_queue->is_empty()) {
+        if (getSecondsElapsed(remesh_budget_start, getWallClock()) * 1e6 > CHUNK_REMESH_BUDGET_MICROSECONDS) break;
+
+        Chunk* chunk = remesh_queue->pop();
+
+        // NOTE: Uniform chunks with nothing to show don't even need to
+        // look at their blocks.
+        if (isChunkMeshTriviallyEmpty(&game_state->world_hashmap, chunk)) {
+            chunk->needs_remeshing = false;
+            chunk->dirty_sections = 0;
+            chunk->vertices_count = 0;
+            chunk->mesh_ranges = {};
+            chunk->mesh_slots = {};
+            removeChunkFromList(dirty_chunks, CHUNK_LIST_DIRTY, chunk);
+            removeChunkFromList(visible_chunks, CHUNK_LIST_VISIBLE, chunk);
+            game_state->skipped_meshings_count++;
+            continue;
+        }
+
+        i64 remesh_start = getWallClock();
+
+        PaddedChunk padded;
+        gatherPaddedChunk(&game_state->world_hashmap, chunk, &padded);
+        downsamplePaddedChunk(&padded, chunk->lod);
+
+        // NOTE: The face masks are needed by all the meshers to know the
+        // exact size of the mesh before generating it.
+        ChunkFaceMasks face_masks;
+        buildChunkFaceMasks(&padded, &face_masks);
+        ChunkFaceTypes face_types;
+        buildChunkFaceTypes(&padded, &face_types);
+
+        // NOTE: Every section is counted, even when only some of them are
+        // dirty: the new sizes tell us if the dirty sections still fit in
+        // their slots.
+        ChunkFaceMasks section_masks[CHUNK_MESH_SECTIONS];
+        ChunkMeshRanges section_counts[CHUNK_MESH_SECTIONS];
+        for (u32 section = 0; section < CHUNK_MESH_SECTIONS; section++) {
+            restrictChunkFaceMasksToSection(&face_masks, section, &section_masks[section]);
+            if (game_state->chunk_mesher == CHUNK_MESHER_GREEDY) {
+                countGreedyChunkMeshVertices(&section_masks[section], &face_types, &section_counts[section]);
+            } else {
+                countChunkMeshVertices(&section_masks[section], &section_counts[section]);
+            }
+        }
+
+        // NOTE: A section that outgrew one of its slots means the whole
+        // layout has to change, so we fall back to a full remesh.
+        b32 is_full_remesh = chunk->needs_remeshing;
+        b32 is_fallback = false;
+        u8 sections_to_upload = is_full_remesh ? ALL_CHUNK_SECTIONS : chunk->dirty_sections;
+        for (u32 section = 0; section < CHUNK_MESH_SECTIONS && !is_full_remesh; section++) {
+            if (!(sections_to_upload & (1 << section))) continue;
+            for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+                if (section_counts[section].vertices_count[direction] > chunk->mesh_slots.capacity[direction][section]) {
+                    is_full_remesh = true;
+                    is_fallback = true;
+                    sections_to_upload = ALL_CHUNK_SECTIONS;
+                    break;
+                }
+            }
+        }
+
+        usize vertices_to_generate = 0;
+        for (u32 section = 0; section < CHUNK_MESH_SECTIONS; section++) {
+            if (!(sections_to_upload & (1 << section))) continue;
+            for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+                vertices_to_generate += section_counts[section].vertices_count[direction];
+            }
+        }
+
+        // NOTE: The meshes are written back to back in the frame's staging
+        // memory. Empty chunks don't need any.
+        StagingAllocation staging = {};
+        if (vertices_to_generate) {
+            staging = rendererRequestStagingMemory(&game_state->renderer, vertices_to_generate * sizeof(ChunkVertex));
+            // NOTE: No more staging memory available !
+            // The remaining chunks will have to wait for the next frame.
+            if (staging.mapped_data == nullptr) break;
+        }
 
         // WARNING: I originally forgot to put this !
         // This needs to be before we continue in case
         // of empty chunk, but after we break if there
-        // are no more staging buffers available.
+        // is no more staging memory available.
         chunk->needs_remeshing = false;
+        chunk->dirty_sections = 0;
+        removeChunkFromList(dirty_chunks, CHUNK_LIST_DIRTY, chunk);
+
+        // NOTE: Lay out the slots again, with some slack so that the next
+        // edits can grow a section in place. The slack is a quarter of the
+        // section's mesh, and at least 4 quads. Empty slots get no slack:
+        // faces appearing in them are rare enough to afford a full remesh.
+        if (is_full_remesh) {
+            u32 first_vertex = 0;
+            for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+                chunk->mesh_ranges.first_vertex[direction] = first_vertex;
+                for (u32 section = 0; section < CHUNK_MESH_SECTIONS; section++) {
+                    u32 count = section_counts[section].vertices_count[direction];
+                    u32 slack = (count / 4) & ~3u;
+                    if (slack < 16) slack = 16;
+
+                    chunk->mesh_slots.first_vertex[direction][section] = first_vertex;
+                    chunk->mesh_slots.capacity[direction][section] = count ? count + slack : 0;
+                    first_vertex += chunk->mesh_slots.capacity[direction][section];
+                }
+                chunk->mesh_ranges.vertices_count[direction] = first_vertex - chunk->mesh_ranges.first_vertex[direction];
+            }
+            chunk->vertices_count = first_vertex;
 
-        usize generated_vertices;
-        generateNaiveChunkMesh(
-            &game_state->world_hashmap,
-            chunk,
-            (ChunkVertex*)staging_buffer->alloc.mapped_data,
-            &generated_vertices
-        );
-        ASSERT(generated_vertices * sizeof(ChunkVertex) <= staging_buffer->alloc.alloc_size);
-
-        chunk->vertices_count = generated_vertices;
+            if (chunk->vertices_count) {
+                addChunkToList(visible_chunks, CHUNK_LIST_VISIBLE, chunk);
+            } else {
+                removeChunkFromList(visible_chunks, CHUNK_LIST_VISIBLE, chunk);
+            }
+        }
 
         // NOTE: Empty chunk ! No need to bother with it.
         if (chunk->vertices_count == 0) continue;
 
         // NOTE: If the current vertex buffer is too small, we need to allocate a bigger one.
-        if (chunk->vertex_buffer.alloc.alloc_size < generated_vertices * sizeof(ChunkVertex)) {
+        // This can only happen on a full remesh, so the whole buffer gets uploaded.
+        if (chunk->vertex_buffer.alloc.alloc_size < chunk->vertices_count * sizeof(ChunkVertex)) {
+            ASSERT(is_full_remesh);
 
             // NOTE: Compute the size to allocate. If the buffer has never been allocated,
             // we'll start at 32K. Otherwise, multiply the size by 2, so that we don't have
             // to reallocate on every change. This is kinda like std::vector !
             usize to_allocate_size = chunk->vertex_buffer.buffer != nullptr ? chunk->vertex_buffer.alloc.alloc_size : KILOBYTES(32);
-            while (to_allocate_size < generated_vertices * sizeof(ChunkVertex)) {
+            while (to_allocate_size < chunk->vertices_count * sizeof(ChunkVertex)) {
                 to_allocate_size *= 2;
             }
 
@@ -722,27 +1835,113 @@ void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, I
             );
         }
 
-        // NOTE: Record the transfer.
-        VkBufferCopy copy_region = {};
-        copy_region.srcOffset = 0;
-        copy_region.dstOffset = 0;
-        copy_region.size = generated_vertices * sizeof(ChunkVertex);
+        // NOTE: Mesh the sections one after the other in staging memory, and
+        // record a copy region to the slot of every (direction, section). The
+        // unused end of each slot is zeroed: all its vertices end up on the
+        // chunk origin, so the triangles made from them are never rasterized.
+        VkBufferCopy copy_regions[FACE_DIRECTION_COUNT * CHUNK_MESH_SECTIONS];
+        u32 copy_regions_count = 0;
+        usize staging_vertices_used = 0;
+
+        for (u32 section = 0; section < CHUNK_MESH_SECTIONS; section++) {
+            if (!(sections_to_upload & (1 << section))) continue;
+
+            ChunkVertex* section_vertices = (ChunkVertex*)staging.mapped_data + staging_vertices_used;
+            usize generated_vertices;
+            ChunkMeshRanges ranges;
+
+            switch (game_state->chunk_mesher) {
+                case CHUNK_MESHER_NAIVE: {
+                    generateNaiveChunkMesh(&padded, section, section_vertices, &generated_vertices, &ranges);
+                } break;
+                case CHUNK_MESHER_BITMASK: {
+                    generateBitmaskChunkMesh(&section_masks[section], &face_types, section_vertices, &generated_vertices, &ranges);
+                } break;
+                case CHUNK_MESHER_GREEDY: {
+                    generateGreedyChunkMesh(&section_masks[section], &face_types, section_vertices, &generated_vertices, &ranges);
+                } break;
+                default: {
+                    ASSERT(false);
+                } break;
+            }
 
-        vkCmdCopyBuffer(current_frame.cmd_buffer, staging_buffer->buffer, chunk->vertex_buffer.buffer, 1, &copy_region);
+            #if ENGINE_SLOW
+            // NOTE: Check that the mesher covers the exact same surface as
+            // the reference mesher, with the same block types, and that every
+            // direction range only has faces pointing in that direction and
+            // matches the count.
+            f32 reference_area[FACE_DIRECTION_COUNT];
+            f32 mesh_area[FACE_DIRECTION_COUNT];
+            f32 reference_type_area[BLOCK_TYPE_COUNT];
+            f32 mesh_type_area[BLOCK_TYPE_COUNT];
+            usize reference_vertices_count;
+            ChunkMeshRanges reference_ranges;
+            generateNaiveChunkMesh(&padded, section, reference_vertices, &reference_vertices_count, &reference_ranges);
+            debugMeasureChunkMeshArea(reference_vertices, reference_vertices_count, reference_area, reference_type_area);
+            debugMeasureChunkMeshArea(section_vertices, generated_vertices, mesh_area, mesh_type_area);
+            for (u32 block_type = 0; block_type < BLOCK_TYPE_COUNT; block_type++) {
+                ASSERT(mesh_type_area[block_type] == reference_type_area[block_type]);
+            }
+
+            usize ranges_vertices_count = 0;
+            for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+                ASSERT(mesh_area[direction] == reference_area[direction]);
+                ASSERT(ranges.first_vertex[direction] == ranges_vertices_count);
+                ASSERT(ranges.vertices_count[direction] == section_counts[section].vertices_count[direction]);
+                for (u32 i = 0; i < ranges.vertices_count[direction]; i++) {
+                    ASSERT(unpackChunkVertexFace(section_vertices[ranges.first_vertex[direction] + i]) == direction);
+                }
+                ranges_vertices_count += ranges.vertices_count[direction];
+            }
+            ASSERT(ranges_vertices_count == generated_vertices);
+            #endif
+
+            for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+                u32 slot_first_vertex = chunk->mesh_slots.first_vertex[direction][section];
+                u32 slot_capacity = chunk->mesh_slots.capacity[direction][section];
+                u32 count = ranges.vertices_count[direction];
+                ASSERT(count <= slot_capacity);
+
+                if (count) {
+                    VkBufferCopy* copy_region = &copy_regions[copy_regions_count++];
+                    copy_region->srcOffset = staging.offset + (staging_vertices_used + ranges.first_vertex[direction]) * sizeof(ChunkVertex);
+                    copy_region->dstOffset = slot_first_vertex * sizeof(ChunkVertex);
+                    copy_region->size = count * sizeof(ChunkVertex);
+                }
+
+                if (slot_capacity > count) {
+                    vkCmdFillBuffer(
+                        current_frame.cmd_buffer,
+                        chunk->vertex_buffer.buffer,
+                        (slot_first_vertex + count) * sizeof(ChunkVertex),
+                        (slot_capacity - count) * sizeof(ChunkVertex),
+                        0
+                    );
+                }
+            }
+
+            staging_vertices_used += generated_vertices;
+        }
+        ASSERT(staging_vertices_used == vertices_to_generate);
+
+        // NOTE: Record the transfer.
+        if (copy_regions_count) {
+            vkCmdCopyBuffer(current_frame.cmd_buffer, staging.buffer, chunk->vertex_buffer.buffer, copy_regions_count, copy_regions);
+        }
 
         // NOTE: Vertex attributes reading stages accessing this buffer after
-        // this barrier will have to wait on copy stages that wrote to it
-        // before the barrier.
+        // this barrier will have to wait on copy and fill stages that wrote
+        // to it before the barrier.
         VkBufferMemoryBarrier2 transfer_barrier = {};
         transfer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
-        transfer_barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        transfer_barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT;
         transfer_barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
         transfer_barrier.dstStageMask = VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT;
         transfer_barrier.dstAccessMask = VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT;
         transfer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         transfer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
         transfer_barrier.buffer = chunk->vertex_buffer.buffer;
-        transfer_barrier.size = generated_vertices * sizeof(ChunkVertex);
+        transfer_barrier.size = chunk->vertices_count * sizeof(ChunkVertex);
 
         VkDependencyInfo transfer_barrier_dep_info = {};
         transfer_barrier_dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
@@ -750,6 +1949,13 @@ void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, I
         transfer_barrier_dep_info.bufferMemoryBarrierCount = 1;
 
         vkCmdPipelineBarrier2(current_frame.cmd_buffer, &transfer_barrier_dep_info);
+
+        if (is_fallback) {
+            game_state->section_remesh_fallbacks_count++;
+        } else if (!is_full_remesh) {
+            game_state->section_remeshes_count++;
+            game_state->last_section_remesh_microseconds = getSecondsElapsed(remesh_start, getWallClock()) * 1e6;
+        }
     }
 
     // NOTE: Transition the framebuffer into a format suitable for rendering.
@@ -870,14 +2076,17 @@ void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, I
         );
     }
 
-    // NOTE: Draw the chunks !
+    // NOTE: The index buffer is the same for all the chunks.
+    vkCmdBindIndexBuffer(current_frame.cmd_buffer, game_state->chunk_index_buffer.buffer, 0, VK_INDEX_TYPE_UINT16);
 
-    for (u32 chunk_idx = 0; chunk_idx < CHUNK_POOL_SIZE; chunk_idx++) {
-        Chunk* chunk = &game_state->chunk_pool.slots[chunk_idx];
-        if (!chunk->is_loaded) continue;
+    // NOTE: Draw the chunks !
 
-        // NOTE: Do not issue a draw call for empty chunks.
-        if (chunk->vertices_count == 0) continue;
+    // NOTE: Only the chunks with a mesh are in the visible list, so no draw
+    // call is issued for empty chunks.
+    usize drawn_vertices = 0;
+    for (usize visible_idx = 0; visible_idx < visible_chunks->count; visible_idx++) {
+        Chunk* chunk = visible_chunks->chunks[visible_idx];
+        ASSERT(chunk->vertices_count > 0);
 
         // NOTE: Very basic "frustum culling" : just check if the chunk is
         // behind the camera. Since this uses the chunk center position,
@@ -922,20 +2131,58 @@ void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, I
         VkDeviceSize offset = 0;
         vkCmdBindVertexBuffers(current_frame.cmd_buffer, 0, 1, &chunk->vertex_buffer.buffer, &offset);
 
-        vkCmdDraw(current_frame.cmd_buffer, chunk->vertices_count, 1, 0, 0);
+        // NOTE: A face can only be seen from the side it points to. So if the
+        // camera is on the negative side of the chunk's lowest X, none of
+        // the +X faces of the chunk can be visible, and so on for every
+        // direction. In the wireframe mode we want to see everything.
+        v3 chunk_min = chunkToWorldPos(chunk->chunk_position);
+        v3 chunk_max = chunk_min + v3 {(f32)CHUNK_W, (f32)CHUNK_W, (f32)CHUNK_W};
+
+        for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+            u32 vertices_count = chunk->mesh_ranges.vertices_count[direction];
+            if (vertices_count == 0) continue;
+
+            if (!game_state->is_wireframe) {
+                u32 axis = direction / 2;
+                b32 is_positive = (direction % 2) == 0;
+                f32 camera_coord = game_state->player_position.data[axis];
+                if (is_positive && camera_coord <= chunk_min.data[axis]) continue;
+                if (!is_positive && camera_coord >= chunk_max.data[axis]) continue;
+            }
+
+            // NOTE: Every quad is 4 vertices and 6 indices. The index buffer
+            // always starts at 0, so the range is selected with the vertex offset.
+            u32 indices_count = vertices_count / 4 * 6;
+            vkCmdDrawIndexed(current_frame.cmd_buffer, indices_count, 1, 0, (i32)chunk->mesh_ranges.first_vertex[direction], 0);
+            drawn_vertices += vertices_count;
+        }
     }
 
     // NOTE: Text rendering test.
     
-    Slice<u8> debug_text_buffer = Slice<u8>((u8*)pushBytes(&game_state->frame_arena, 512), 512);
+    Slice<u8> debug_text_buffer = Slice<u8>((u8*)pushBytes(&game_state->frame_arena, 1024), 1024);
 
     v3i chunk_position = worldPosToChunk(game_state->player_position);
+    u64 heightmap_cache_lookups = game_state->heightmap_cache.hits_count + game_state->heightmap_cache.misses_count;
+    f64 heightmap_cache_hit_rate = heightmap_cache_lookups ? 100.0 * (f64)game_state->heightmap_cache.hits_count / (f64)heightmap_cache_lookups : 0.0;
+    f64 prefetched_entering_rate = game_state->entering_chunks_count ? 100.0 * (f64)game_state->prefetched_entering_chunks_count / (f64)game_state->entering_chunks_count : 0.0;
+    f64 retained_entering_rate = game_state->entering_chunks_count ? 100.0 * (f64)game_state->retained_entering_chunks_count / (f64)game_state->entering_chunks_count : 0.0;
     StrView debug_text_view = formatString(
         debug_text_buffer,
         "Pos: {f32}, {f32}, {f32}\n"
         "Chunk: {i32}, {i32}, {i32}\n"
         "Hashmap: {u64}/{u64}\n"
-        "Pool: {u64}/{u64}",
+        "Pool: {u64}/{u64}, {u64} dirty, {u64} visible\n"
+        "Drawn vertices: {u64}\n"
+        "Uniform chunks: {u64} air, {u64} solid, {u64}/{u64} loads pre-classified\n"
+        "Blocks pool: {u64}/{u64}\n"
+        "Revive cache: {u64}/{u64} chunks, {u64} revived, {u64} generated\n"
+        "Prefetch: {u64} chunks ahead, {u64} prefetched, {u64} cancelled, on entry {f64}% prefetched, {f64}% retained\n"
+        "Skipped meshings: {u64}\n"
+        "Section remeshes: {u64} ({u64} fallbacks), last {f64}us\n"
+        "LOD chunks (L): {u64} full, {u64} 2x, {u64} 4x\n"
+        "Heightmap cache: {u64}/{u64} columns, {f64}% hits, noise x{u32}\n"
+        "Generation: {u32} workers, {u64} jobs in flight, {u64} chunks integrated, {u64} columns queued",
         game_state->player_position.x(),
         game_state->player_position.y(),
         game_state->player_position.z(),
@@ -945,7 +2192,40 @@ void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, I
         game_state->world_hashmap.nb_occupied,
         WORLD_HASHMAP_SIZE,
         game_state->chunk_pool.nb_allocated,
-        CHUNK_POOL_SIZE
+        CHUNK_POOL_SIZE,
+        (u64)game_state->chunk_lists[CHUNK_LIST_DIRTY].count,
+        (u64)game_state->chunk_lists[CHUNK_LIST_VISIBLE].count,
+        drawn_vertices,
+        game_state->uniform_air_chunks_count,
+        game_state->uniform_solid_chunks_count,
+        game_state->classified_chunks_count,
+        game_state->classified_chunks_count + game_state->generated_chunks_count,
+        game_state->chunk_blocks_pool.nb_allocated,
+        CHUNK_POOL_SIZE + CHUNK_REVIVE_CACHE_SIZE,
+        (u64)game_state->chunk_revive_cache.hashmap.nb_occupied,
+        CHUNK_REVIVE_CACHE_SIZE,
+        game_state->revived_chunks_count,
+        game_state->generated_chunks_count,
+        (u64)game_state->chunk_lists[CHUNK_LIST_PREFETCHED].count,
+        game_state->prefetched_chunks_count,
+        game_state->cancelled_prefetches_count,
+        prefetched_entering_rate,
+        retained_entering_rate,
+        game_state->skipped_meshings_count,
+        game_state->section_remeshes_count,
+        game_state->section_remesh_fallbacks_count,
+        game_state->last_section_remesh_microseconds,
+        game_state->lod_chunks_count[0],
+        game_state->lod_chunks_count[1],
+        game_state->lod_chunks_count[2],
+        game_state->heightmap_cache.entries_count,
+        HEIGHTMAP_CACHE_SIZE,
+        heightmap_cache_hit_rate,
+        simplex_noise_batch_lanes(),
+        memory->worker_threads_count,
+        (u64)game_state->chunk_generation_jobs_pool.nb_allocated,
+        game_state->last_integrated_chunks_count,
+        (u64)game_state->chunk_load_queue.count
     );
     drawDebugTextOnScreen(
         &game_state->renderer,
@@ -961,9 +2241,12 @@ void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, I
 
     StrView debug_vram_usage_view = formatString(
         debug_vram_usage_buffer,
-        "VRAM Usage:\n{size} / {size}",
+        "VRAM Usage:\n{size} / {size}\n"
+        "Staging: {size} / {size}",
         vram_usage,
-        game_state->renderer.vram_allocator.allocator.total_size
+        game_state->renderer.vram_allocator.allocator.total_size,
+        game_state->renderer.staging_bytes_used,
+        STAGING_BUFFER_SIZE
     );
     drawDebugTextOnScreen(
         &game_state->renderer,
@@ -971,9 +2254,92 @@ void gameUpdate(f32 dt, GamePlatformState* platform_state, GameMemory* memory, I
         current_frame.cmd_buffer,
         debug_vram_usage_view,
         0,
-        5
+        14
+    );
+
+    StrView mesher_names[CHUNK_MESHER_COUNT] = {
+        "Mesher: naive (M)",
+        "Mesher: bitmask (M)",
+        "Mesher: greedy (M)",
+    };
+    drawDebugTextOnScreen(
+        &game_state->renderer,
+        &game_state->text_rendering_state,
+        current_frame.cmd_buffer,
+        mesher_names[game_state->chunk_mesher],
+        0,
+        17
+    );
+
+    StrView terrain_names[TERRAIN_PRESETS_COUNT] = {
+        "Terrain: hills (T)",
+        "Terrain: mountains (T)",
+        "Terrain: cliffs, quality (T)",
+        "Terrain: cliffs (T)",
+        "Terrain: cliffs, fast (T)",
+    };
+    drawDebugTextOnScreen(
+        &game_state->renderer,
+        &game_state->text_rendering_state,
+        current_frame.cmd_buffer,
+        terrain_names[game_state->terrain_preset_idx],
+        24,
+        17
     );
 
+    if (game_state->meshing_benchmark.has_run) {
+        Slice<u8> debug_benchmark_buffer = Slice<u8>((u8*)pushBytes(&game_state->frame_arena, 512), 512);
+        StrView debug_benchmark_view = formatString(
+            debug_benchmark_buffer,
+            "Meshing benchmark (B), {u64} chunks, us/chunk:\n",
+            game_state->meshing_benchmark.chunks_count
+        );
+
+        // NOTE: One entry per path, three per line.
+        for (u32 path = 0; path < MESHING_BENCHMARK_PATH_COUNT; path++) {
+            const char* separator = path == MESHING_BENCHMARK_PATH_COUNT - 1 ? "" : (path % 3 == 2 ? "\n" : " | ");
+            Slice<u8> remaining_buffer = Slice<u8>(debug_benchmark_buffer.ptr + debug_benchmark_view.len, debug_benchmark_buffer.len - debug_benchmark_view.len);
+            StrView path_view = formatString(
+                remaining_buffer,
+                "{str} {f64}{str}",
+                MESHING_BENCHMARK_PATH_NAMES[path],
+                game_state->meshing_benchmark.microseconds[path],
+                separator
+            );
+            debug_benchmark_view.len += path_view.len;
+        }
+        drawDebugTextOnScreen(
+            &game_state->renderer,
+            &game_state->text_rendering_state,
+            current_frame.cmd_buffer,
+            debug_benchmark_view,
+            0,
+            18
+        );
+    }
+
+    if (game_state->terrain_benchmark.has_run) {
+        Slice<u8> debug_terrain_benchmark_buffer = Slice<u8>((u8*)pushBytes(&game_state->frame_arena, 512), 512);
+        StrView debug_terrain_benchmark_view = formatString(
+            debug_terrain_benchmark_buffer,
+            "Terrain benchmark (B), Mvoxels/s per core:\n"
+            "hills {f64} | mountains {f64} | cliffs quality {f64} | cliffs {f64} | cliffs fast {f64}",
+            game_state->terrain_benchmark.mvoxels_per_second[0],
+            game_state->terrain_benchmark.mvoxels_per_second[1],
+            game_state->terrain_benchmark.mvoxels_per_second[2],
+            game_state->terrain_benchmark.mvoxels_per_second[3],
+            game_state->terrain_benchmark.mvoxels_per_second[4]
+        );
+        drawDebugTextOnScreen(
+            &game_state->renderer,
+            &game_state->text_rendering_state,
+            current_frame.cmd_buffer,
+            debug_terrain_benchmark_view,
+            0,
+            21
+        );
+    }
+
     vkCmdEndRendering(current_frame.cmd_buffer);
 
     // NOTE: Transition the framebuffer into a format suitable for presentation.
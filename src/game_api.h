@@ -11,10 +11,28 @@ struct GamePlatformState {
     b32 surface_is_minimized;
 };
 
+// NOTE: Work the platform runs on its worker threads. The callbacks live in
+// the game code, so the platform waits for the queue to be empty before
+// reloading it. Entries are run in any order, and the queue can hold at most
+// PLATFORM_WORK_QUEUE_SIZE - 1 of them at once.
+constexpr u32 PLATFORM_WORK_QUEUE_SIZE = 512;
+
+struct PlatformWorkQueue;
+typedef void PlatformWorkQueueCallback(void* data);
+typedef void PlatformAddWorkEntry(PlatformWorkQueue* queue, PlatformWorkQueueCallback* callback, void* data);
+// NOTE: Blocks until every entry added so far is done. The calling thread
+// helps with the work instead of just waiting.
+typedef void PlatformCompleteAllWork(PlatformWorkQueue* queue);
+
 struct GameMemory {
     bool  is_initialized;
     usize permanent_storage_size;
     void* permanent_storage; // NOTE: guaranteed to be filled with zeros at init
+
+    PlatformWorkQueue* work_queue;
+    u32 worker_threads_count;
+    PlatformAddWorkEntry* platformAddWorkEntry;
+    PlatformCompleteAllWork* platformCompleteAllWork;
 };
 
 // TODO: should we pass the function pointers every frame ?
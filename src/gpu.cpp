@@ -553,7 +553,7 @@ b32 initDescPool(Renderer* to_init) {
 b32 initStaging(Renderer* to_init) {
 
     for (AllocatedBuffer& staging_buffer : to_init->staging_buffers) {
-        staging_buffer = graphicsMemoryAllocateBuffer(&to_init->staging_allocator, STAGING_BUFFER_MIN_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);        
+        staging_buffer = graphicsMemoryAllocateBuffer(&to_init->staging_allocator, STAGING_BUFFER_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);        
     }
 
     return true;  
@@ -621,9 +621,15 @@ b32 rendererResizeSwapchain(Renderer* renderer, GamePlatformState* platform_stat
 }
 
 
-AllocatedBuffer* rendererRequestStagingBuffer(Renderer* renderer) {
-    if(renderer->distributed_staging_buffers >= STAGING_BUFFERS_PER_FRAME) {
-        return nullptr;
+StagingAllocation rendererRequestStagingMemory(Renderer* renderer, usize size) {
+    // NOTE: Keep every allocation aligned, buffer to image copies need
+    // the offset to be a multiple of the texel size.
+    constexpr usize STAGING_ALIGNMENT = 16;
+    usize offset = (renderer->staging_bytes_used + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+
+    StagingAllocation result = {};
+    if (offset + size > STAGING_BUFFER_SIZE) {
+        return result;
     }
 
     // FIXME: We assume that by the time we get to doing CPU work for
@@ -634,13 +640,22 @@ AllocatedBuffer* rendererRequestStagingBuffer(Renderer* renderer) {
     // For now, I think I will just try to write to staging buffers only
     // AFTER that vkWaitForFences call.
     u32 current_frame = renderer->frames_counter % FRAMES_IN_FLIGHT;
+    AllocatedBuffer* staging_buffer = &renderer->staging_buffers[current_frame];
+
+    result.buffer = staging_buffer->buffer;
+    result.offset = offset;
+    result.size = size;
+    result.mapped_data = staging_buffer->alloc.mapped_data + offset;
 
-    AllocatedBuffer* result = &renderer->staging_buffers[current_frame * STAGING_BUFFERS_PER_FRAME + renderer->distributed_staging_buffers];
-    renderer->distributed_staging_buffers++;
+    renderer->staging_bytes_used = offset + size;
 
     return result;
 }
 
+void rendererResetStagingMemory(Renderer* renderer) {
+    renderer->staging_bytes_used = 0;
+}
+
 VkDeviceMemory debugAllocateDirectGPUMemory(Renderer* vk_context, VkMemoryPropertyFlags memory_properties, usize size) {
     VkPhysicalDeviceMemoryProperties2 mem_props = {};
     mem_props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
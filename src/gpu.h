@@ -70,9 +70,19 @@ struct Frame {
     AllocatedImage depth_img;
 };
 
-constexpr u32 STAGING_BUFFERS_PER_FRAME = 16;
-// NOTE: The size of the worst case chunk mesh for now.
-constexpr u32 STAGING_BUFFER_MIN_SIZE = MEGABYTES(2);
+// NOTE: How many bytes can be uploaded to the GPU each frame. Uploads are
+// packed back to back in a single staging buffer per frame, so this is the
+// only limit on how many chunks can be remeshed in a frame.
+constexpr usize STAGING_BUFFER_SIZE = MEGABYTES(8);
+
+// NOTE: A piece of the current frame's staging buffer. The copy
+// commands need to use the offset into the buffer.
+struct StagingAllocation {
+    VkBuffer buffer;
+    usize offset;
+    usize size;
+    u8* mapped_data;
+};
 
 struct Renderer {
     HWND window;
@@ -111,20 +121,23 @@ struct Renderer {
     // reuse the abstractions I already wrote.
     GraphicsMemoryAllocator staging_allocator;
 
-    // NOTE: There is number of staging buffers per frame for uploads.
+    // NOTE: There is one staging buffer per frame for uploads.
     // I think it's better to separate per frames so you don't use a staging
     // buffer that's being copied from during the execution of frame A's
-    // commands while you are recording frame B's commands.
-    AllocatedBuffer staging_buffers[FRAMES_IN_FLIGHT*STAGING_BUFFERS_PER_FRAME];
-    u32 distributed_staging_buffers;
+    // commands while you are recording frame B's commands. Uploads are
+    // bump-allocated from it, and it is reset at the start of the frame.
+    AllocatedBuffer staging_buffers[FRAMES_IN_FLIGHT];
+    usize staging_bytes_used;
 
     VkDescriptorPool global_desc_pool;
 };
 
 b32 rendererInitialize(Renderer* to_init, GamePlatformState* platform_state, b32 debug_mode, Arena* static_arena, Arena* scratch_arena);
 b32 rendererResizeSwapchain(Renderer* renderer, GamePlatformState* platform_state);
-// NOTE: Returns NULL if no more staging buffers available for this frame.
-AllocatedBuffer* rendererRequestStagingBuffer(Renderer* renderer);
+// NOTE: Returns an allocation with mapped_data set to NULL if there is not
+// enough staging memory left for this frame.
+StagingAllocation rendererRequestStagingMemory(Renderer* renderer, usize size);
+void rendererResetStagingMemory(Renderer* renderer);
 
 VkShaderModule loadAndCreateShader(Renderer* vk_context, const char* path, Arena* scratch_arena);
 
@@ -14,7 +14,7 @@
 
 #define PI32 3.14159265359f
 
-inline i32 mfloor(f32 x) {
+constexpr i32 mfloor(f32 x) {
     i32 truncated = (i32)x;
     return x < truncated ? (truncated - 1) : truncated;
 }
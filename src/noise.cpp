@@ -1,6 +1,13 @@
+#include <immintrin.h>
+#include <cpuid.h>
+
 #include "noise.h"
 #include "maths.h"
 
+// NOTE: AVX-512 implies FMA, and fusing a multiply with an add changes the
+// rounding. The SIMD paths have to match the scalar version exactly.
+#pragma STDC FP_CONTRACT OFF
+
 // NOTE: This article is great to understand how simplex noise works, and has a reference implementation.
 // https://cgvr.cs.uni-bremen.de/teaching/cg_literatur/simplexnoise.pdf
 
@@ -9,31 +16,37 @@
 // the article implementation.
 // https://github.com/SRombauts/SimplexNoise/blob/master/src/SimplexNoise.cpp
 
-// TODO: OpenSimplex2 does not seem to use a precomputed permutation table, and
-// the exposed functions additionally take in a seed. Maybe this is something that can
-// be added to the classic simplex ?
+// NOTE: Like OpenSimplex2, the gradient of a lattice point is picked by hashing
+// its coordinates with the seed, instead of going through a permutation table.
+// There is no table to seed and no dependent byte lookups (which are slow to
+// gather in SIMD), and the noise doesn't repeat every 256 units. The primes and
+// the multiplier are the 32 bit ones from FastNoiseLite's OpenSimplex2.
 // https://github.com/KdotJPG/OpenSimplex2/
+// https://github.com/Auburn/FastNoiseLite
+constexpr u32 HASH_PRIME_X = 501125321;
+constexpr u32 HASH_PRIME_Y = 1136930381;
+constexpr u32 HASH_PRIME_Z = 1720413743;
+constexpr u32 HASH_MULTIPLIER = 0x27D4EB2D;
 
+// NOTE: The 64 bit seed is folded once, the hashes are 32 bit so that they
+// stay cheap in SIMD (no 64 bit multiplies before AVX-512DQ).
+inline u32 fold_seed(u64 seed) {
+    return (u32)seed ^ (u32)(seed >> 32);
+}
 
-void simplex_table_from_seed(SimplexTable* to_init, u64 seed) {
-
-    for (usize i = 0; i < ARRAY_COUNT(to_init->permutations); i++) {
-        to_init->permutations[i] = i;
-    }
-
-    // NOTE: This is called a Fisher–Yates shuffle, apparently.
-    for (usize i = ARRAY_COUNT(to_init->permutations) - 1; i > 0; i--) {
-        f32 r = randomUnilateral(&seed);
-        usize j = (usize)(r * (f32)i);
-
-        u8 tmp = to_init->permutations[i];
-        to_init->permutations[i] = to_init->permutations[j];
-        to_init->permutations[j] = tmp;
-    }
+// NOTE: The multiply mixes the low bits into the high ones, so we keep the
+// top 6 bits, which is what grad() looks at.
+inline i32 hash_lattice_point(u32 seed, i32 i, i32 j) {
+    u32 hash = seed ^ ((u32)i * HASH_PRIME_X) ^ ((u32)j * HASH_PRIME_Y);
+    hash *= HASH_MULTIPLIER;
+    return (i32)(hash >> 26);
 }
 
-inline i32 perm_hash(SimplexTable* simplex_state, i32 i) {
-    return (i32)simplex_state->permutations[i & 0xFF];
+// NOTE: Same thing in 3D, but grad3() only looks at 4 bits.
+inline i32 hash_lattice_point_3d(u32 seed, i32 i, i32 j, i32 k) {
+    u32 hash = seed ^ ((u32)i * HASH_PRIME_X) ^ ((u32)j * HASH_PRIME_Y) ^ ((u32)k * HASH_PRIME_Z);
+    hash *= HASH_MULTIPLIER;
+    return (i32)(hash >> 28);
 }
 
 inline i32 fastfloor(f32 x) {
@@ -51,15 +64,15 @@ f32 grad(i32 hash, f32 x, f32 y) {
     return ((h & 1) ? -u : u) + ((h & 2) ? -2.0f * v : 2.0f * v);
 }
 
-f32 simplex_noise_2d(SimplexTable* simplex_table, f32 x, f32 y) {
-    f32 n0, n1, n2;
+// NOTE: Factors to skew a simplex grid into a regular grid.
+// These constants actually come from the math on how to stretch
+// a triangle grid over a square grid.
+// For example, F2 = 0.5*(sqrt(3.0)-1.0).
+constexpr f32 F2 = 0.366025403f;
+constexpr f32 G2 = 0.211324865f;
 
-    // NOTE: Factors to skew a simplex grid into a regular grid.
-    // These constants actually come from the math on how to stretch
-    // a triangle grid over a square grid.
-    // For example, F2 = 0.5*(sqrt(3.0)-1.0).
-    constexpr f32 F2 = 0.366025403f;
-    constexpr f32 G2 = 0.211324865f;
+f32 simplex_noise_2d(u64 seed, f32 x, f32 y) {
+    f32 n0, n1, n2;
 
     // NOTE: Skew the simplex input space onto a square grid.
     // Once that is done, you can just use floor to find out which simplex cell you are on.
@@ -103,10 +116,11 @@ f32 simplex_noise_2d(SimplexTable* simplex_table, f32 x, f32 y) {
     const f32 x2 = x0 - 1.0f + 2.0f * G2;
     const f32 y2 = y0 - 1.0f + 2.0f * G2;
 
-    // NOTE: Use the pseudo-hash lookup table to get a "random" value per simplex corner.
-    const i32 gi0 = perm_hash(simplex_table, i + perm_hash(simplex_table, j));
-    const i32 gi1 = perm_hash(simplex_table, i + i1 + perm_hash(simplex_table, j + j1));
-    const i32 gi2 = perm_hash(simplex_table, i + 1 + perm_hash(simplex_table, j + 1));
+    // NOTE: Hash the corners to get a "random" value per simplex corner.
+    const u32 folded_seed = fold_seed(seed);
+    const i32 gi0 = hash_lattice_point(folded_seed, i, j);
+    const i32 gi1 = hash_lattice_point(folded_seed, i + i1, j + j1);
+    const i32 gi2 = hash_lattice_point(folded_seed, i + 1, j + 1);
 
     // NOTE: Calculate the contribution from the first corner.
     float t0 = 0.5f - x0*x0 - y0*y0;
@@ -138,3 +152,712 @@ f32 simplex_noise_2d(SimplexTable* simplex_table, f32 x, f32 y) {
     // NOTE: The scaling factor creates a value between -1 and 1.
     return 45.23065f * (n0 + n1 + n2);
 }
+
+// NOTE: Picks one of the 12 gradients pointing to the edges of a cube (4 of
+// them twice) from the hash, and does the dot product with (x, y, z).
+f32 grad3(i32 hash, f32 x, f32 y, f32 z) {
+    const i32 h = hash & 15;
+    const f32 u = h < 8 ? x : y;
+    const f32 v = h < 4 ? y : (h == 12 || h == 14) ? x : z;
+    return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+// NOTE: Factors to skew a 3D simplex grid (made of tetrahedrons) into a cube grid.
+constexpr f32 F3 = 1.0f / 3.0f;
+constexpr f32 G3 = 1.0f / 6.0f;
+
+f32 simplex_noise_3d(u64 seed, f32 x, f32 y, f32 z) {
+    f32 n0, n1, n2, n3;
+
+    // NOTE: Skew the input space to find out which cube we are in.
+    const f32 s = (x + y + z) * F3;
+    const i32 i = fastfloor(x + s);
+    const i32 j = fastfloor(y + s);
+    const i32 k = fastfloor(z + s);
+
+    // NOTE: Unskew back to get the offset to the first corner.
+    const f32 t = (f32)(i + j + k) * G3;
+    const f32 X0 = i - t;
+    const f32 Y0 = j - t;
+    const f32 Z0 = k - t;
+    const f32 x0 = x - X0;
+    const f32 y0 = y - Y0;
+    const f32 z0 = z - Z0;
+
+    // NOTE: A cube is split in 6 tetrahedrons, and which one we are in
+    // depends on the order of x0, y0 and z0. (i1, j1, k1) is the offset of the
+    // second corner and (i2, j2, k2) the offset of the third one. The first is
+    // always +(0,0,0) and the last +(1,1,1).
+    i32 i1, j1, k1;
+    i32 i2, j2, k2;
+    if (x0 >= y0) {
+        if (y0 >= z0) {
+            i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0;
+        } else if (x0 >= z0) {
+            i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1;
+        } else {
+            i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1;
+        }
+    } else {
+        if (y0 < z0) {
+            i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1;
+        } else if (x0 < z0) {
+            i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1;
+        } else {
+            i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0;
+        }
+    }
+
+    // NOTE: Offsets to the other corners, like in 2D.
+    const f32 x1 = x0 - i1 + G3;
+    const f32 y1 = y0 - j1 + G3;
+    const f32 z1 = z0 - k1 + G3;
+    const f32 x2 = x0 - i2 + 2.0f * G3;
+    const f32 y2 = y0 - j2 + 2.0f * G3;
+    const f32 z2 = z0 - k2 + 2.0f * G3;
+    const f32 x3 = x0 - 1.0f + 3.0f * G3;
+    const f32 y3 = y0 - 1.0f + 3.0f * G3;
+    const f32 z3 = z0 - 1.0f + 3.0f * G3;
+
+    const u32 folded_seed = fold_seed(seed);
+    const i32 gi0 = hash_lattice_point_3d(folded_seed, i, j, k);
+    const i32 gi1 = hash_lattice_point_3d(folded_seed, i + i1, j + j1, k + k1);
+    const i32 gi2 = hash_lattice_point_3d(folded_seed, i + i2, j + j2, k + k2);
+    const i32 gi3 = hash_lattice_point_3d(folded_seed, i + 1, j + 1, k + 1);
+
+    // NOTE: Contributions of the four corners.
+    f32 t0 = 0.6f - x0*x0 - y0*y0 - z0*z0;
+    if (t0 < 0.0f) {
+        n0 = 0.0f;
+    } else {
+        t0 *= t0;
+        n0 = t0 * t0 * grad3(gi0, x0, y0, z0);
+    }
+
+    f32 t1 = 0.6f - x1*x1 - y1*y1 - z1*z1;
+    if (t1 < 0.0f) {
+        n1 = 0.0f;
+    } else {
+        t1 *= t1;
+        n1 = t1 * t1 * grad3(gi1, x1, y1, z1);
+    }
+
+    f32 t2 = 0.6f - x2*x2 - y2*y2 - z2*z2;
+    if (t2 < 0.0f) {
+        n2 = 0.0f;
+    } else {
+        t2 *= t2;
+        n2 = t2 * t2 * grad3(gi2, x2, y2, z2);
+    }
+
+    f32 t3 = 0.6f - x3*x3 - y3*y3 - z3*z3;
+    if (t3 < 0.0f) {
+        n3 = 0.0f;
+    } else {
+        t3 *= t3;
+        n3 = t3 * t3 * grad3(gi3, x3, y3, z3);
+    }
+
+    // NOTE: The scaling factor creates a value between -1 and 1.
+    return 32.0f * (n0 + n1 + n2 + n3);
+}
+
+// NOTE: The SIMD versions below follow the scalar version line by line, so
+// see there for what the steps do. The differences are:
+// - The "if (t < 0)" of every corner is a mask that zeroes its contribution.
+// - grad() selects and flips signs with masks instead of branches.
+// - The corner hashes are computed for all the lanes at once.
+// - fastfloor() subtracts the all-ones (-1) comparison mask.
+// - In 3D, the tetrahedron is picked by comparing the offsets pairwise: with
+//   xy = x0 >= y0, xz = x0 >= z0 and yz = y0 >= z0, the second corner is
+//   (xy & xz, !xy & yz, !xz & !yz) and the third (xy | xz, !xy | yz, !xz | !yz),
+//   which gives the same corners as the if/else chain, ties included.
+// Every float operation happens in the same order as in the scalar version,
+// and the compiler doesn't fuse separate intrinsics into FMAs, so the results
+// are bit-for-bit identical. The game isn't compiled with -march, so each
+// path enables its instruction set with a target attribute.
+#define SIMPLEX_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SIMPLEX_TARGET_AVX2 __attribute__((target("avx2")))
+#define SIMPLEX_TARGET_AVX512 __attribute__((target("avx512f")))
+
+SIMPLEX_TARGET_SSE41
+static inline __m128 simplex_corner_sse41(__m128 x, __m128 y, __m128i hash) {
+    __m128 t = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(0.5f), _mm_mul_ps(x, x)), _mm_mul_ps(y, y));
+    __m128 is_outside = _mm_cmplt_ps(t, _mm_setzero_ps());
+
+    __m128i h = _mm_and_si128(hash, _mm_set1_epi32(0x3F));
+    __m128 h_below_4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+    __m128 u = _mm_blendv_ps(y, x, h_below_4);
+    __m128 v = _mm_blendv_ps(x, y, h_below_4);
+    __m128 u_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+    __m128 v_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+    __m128 grad = _mm_add_ps(_mm_xor_ps(u, u_sign), _mm_xor_ps(_mm_mul_ps(_mm_set1_ps(2.0f), v), v_sign));
+
+    t = _mm_mul_ps(t, t);
+    __m128 n = _mm_mul_ps(_mm_mul_ps(t, t), grad);
+    return _mm_andnot_ps(is_outside, n);
+}
+
+SIMPLEX_TARGET_SSE41
+static inline __m128i simplex_fastfloor_sse41(__m128 x) {
+    __m128i i = _mm_cvttps_epi32(x);
+    __m128 is_below = _mm_cmplt_ps(x, _mm_cvtepi32_ps(i));
+    return _mm_add_epi32(i, _mm_castps_si128(is_below));
+}
+
+SIMPLEX_TARGET_SSE41
+static inline __m128i simplex_hash_sse41(__m128i folded_seed, __m128i i, __m128i j) {
+    __m128i hash = _mm_xor_si128(folded_seed, _mm_mullo_epi32(i, _mm_set1_epi32((i32)HASH_PRIME_X)));
+    hash = _mm_xor_si128(hash, _mm_mullo_epi32(j, _mm_set1_epi32((i32)HASH_PRIME_Y)));
+    hash = _mm_mullo_epi32(hash, _mm_set1_epi32((i32)HASH_MULTIPLIER));
+    return _mm_srli_epi32(hash, 26);
+}
+
+SIMPLEX_TARGET_SSE41
+static void simplex_noise_2d_sse41(u64 seed, f32* xs, f32* ys, f32* out_values, usize count) {
+    __m128i folded_seed = _mm_set1_epi32((i32)fold_seed(seed));
+    for (usize idx = 0; idx + 4 <= count; idx += 4) {
+        __m128 x = _mm_loadu_ps(xs + idx);
+        __m128 y = _mm_loadu_ps(ys + idx);
+
+        __m128 s = _mm_mul_ps(_mm_add_ps(x, y), _mm_set1_ps(F2));
+        __m128i i = simplex_fastfloor_sse41(_mm_add_ps(x, s));
+        __m128i j = simplex_fastfloor_sse41(_mm_add_ps(y, s));
+
+        __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(i, j)), _mm_set1_ps(G2));
+        __m128 x0 = _mm_sub_ps(x, _mm_sub_ps(_mm_cvtepi32_ps(i), t));
+        __m128 y0 = _mm_sub_ps(y, _mm_sub_ps(_mm_cvtepi32_ps(j), t));
+
+        __m128 second_is_x = _mm_cmpgt_ps(x0, y0);
+        __m128 i1 = _mm_and_ps(second_is_x, _mm_set1_ps(1.0f));
+        __m128 j1 = _mm_andnot_ps(second_is_x, _mm_set1_ps(1.0f));
+
+        __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, i1), _mm_set1_ps(G2));
+        __m128 y1 = _mm_add_ps(_mm_sub_ps(y0, j1), _mm_set1_ps(G2));
+        __m128 x2 = _mm_add_ps(_mm_sub_ps(x0, _mm_set1_ps(1.0f)), _mm_set1_ps(2.0f * G2));
+        __m128 y2 = _mm_add_ps(_mm_sub_ps(y0, _mm_set1_ps(1.0f)), _mm_set1_ps(2.0f * G2));
+
+        __m128i one = _mm_set1_epi32(1);
+        __m128i i1_int = _mm_srli_epi32(_mm_castps_si128(second_is_x), 31);
+        __m128i j1_int = _mm_xor_si128(i1_int, one);
+        __m128i gi0 = simplex_hash_sse41(folded_seed, i, j);
+        __m128i gi1 = simplex_hash_sse41(folded_seed, _mm_add_epi32(i, i1_int), _mm_add_epi32(j, j1_int));
+        __m128i gi2 = simplex_hash_sse41(folded_seed, _mm_add_epi32(i, one), _mm_add_epi32(j, one));
+
+        __m128 n0 = simplex_corner_sse41(x0, y0, gi0);
+        __m128 n1 = simplex_corner_sse41(x1, y1, gi1);
+        __m128 n2 = simplex_corner_sse41(x2, y2, gi2);
+
+        __m128 result = _mm_mul_ps(_mm_set1_ps(45.23065f), _mm_add_ps(_mm_add_ps(n0, n1), n2));
+        _mm_storeu_ps(out_values + idx, result);
+    }
+}
+
+SIMPLEX_TARGET_SSE41
+static inline __m128 simplex_corner_3d_sse41(__m128 x, __m128 y, __m128 z, __m128i hash) {
+    __m128 t = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_set1_ps(0.6f), _mm_mul_ps(x, x)), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+    __m128 is_outside = _mm_cmplt_ps(t, _mm_setzero_ps());
+
+    __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+    __m128 h_below_8 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+    __m128 h_below_4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+    __m128 h_is_12_or_14 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_or_si128(h, _mm_set1_epi32(2)), _mm_set1_epi32(14)));
+    __m128 u = _mm_blendv_ps(y, x, h_below_8);
+    __m128 v = _mm_blendv_ps(_mm_blendv_ps(z, x, h_is_12_or_14), y, h_below_4);
+    __m128 u_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+    __m128 v_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+    __m128 grad = _mm_add_ps(_mm_xor_ps(u, u_sign), _mm_xor_ps(v, v_sign));
+
+    t = _mm_mul_ps(t, t);
+    __m128 n = _mm_mul_ps(_mm_mul_ps(t, t), grad);
+    return _mm_andnot_ps(is_outside, n);
+}
+
+SIMPLEX_TARGET_SSE41
+static inline __m128i simplex_hash_3d_sse41(__m128i folded_seed, __m128i i, __m128i j, __m128i k) {
+    __m128i hash = _mm_xor_si128(folded_seed, _mm_mullo_epi32(i, _mm_set1_epi32((i32)HASH_PRIME_X)));
+    hash = _mm_xor_si128(hash, _mm_mullo_epi32(j, _mm_set1_epi32((i32)HASH_PRIME_Y)));
+    hash = _mm_xor_si128(hash, _mm_mullo_epi32(k, _mm_set1_epi32((i32)HASH_PRIME_Z)));
+    hash = _mm_mullo_epi32(hash, _mm_set1_epi32((i32)HASH_MULTIPLIER));
+    return _mm_srli_epi32(hash, 28);
+}
+
+SIMPLEX_TARGET_SSE41
+static void simplex_noise_3d_sse41(u64 seed, f32* xs, f32* ys, f32* zs, f32* out_values, usize count) {
+    __m128i folded_seed = _mm_set1_epi32((i32)fold_seed(seed));
+    for (usize idx = 0; idx + 4 <= count; idx += 4) {
+        __m128 x = _mm_loadu_ps(xs + idx);
+        __m128 y = _mm_loadu_ps(ys + idx);
+        __m128 z = _mm_loadu_ps(zs + idx);
+
+        __m128 s = _mm_mul_ps(_mm_add_ps(_mm_add_ps(x, y), z), _mm_set1_ps(F3));
+        __m128i i = simplex_fastfloor_sse41(_mm_add_ps(x, s));
+        __m128i j = simplex_fastfloor_sse41(_mm_add_ps(y, s));
+        __m128i k = simplex_fastfloor_sse41(_mm_add_ps(z, s));
+
+        __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_add_epi32(i, j), k)), _mm_set1_ps(G3));
+        __m128 x0 = _mm_sub_ps(x, _mm_sub_ps(_mm_cvtepi32_ps(i), t));
+        __m128 y0 = _mm_sub_ps(y, _mm_sub_ps(_mm_cvtepi32_ps(j), t));
+        __m128 z0 = _mm_sub_ps(z, _mm_sub_ps(_mm_cvtepi32_ps(k), t));
+
+        __m128 xy = _mm_cmpge_ps(x0, y0);
+        __m128 xz = _mm_cmpge_ps(x0, z0);
+        __m128 yz = _mm_cmpge_ps(y0, z0);
+        __m128 is_i1 = _mm_and_ps(xy, xz);
+        __m128 is_j1 = _mm_andnot_ps(xy, yz);
+        __m128 is_not_k1 = _mm_or_ps(xz, yz);
+        __m128 is_i2 = _mm_or_ps(xy, xz);
+        __m128 is_not_j2 = _mm_andnot_ps(yz, xy);
+        __m128 is_not_k2 = _mm_and_ps(xz, yz);
+
+        __m128 one_f = _mm_set1_ps(1.0f);
+        __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, _mm_and_ps(is_i1, one_f)), _mm_set1_ps(G3));
+        __m128 y1 = _mm_add_ps(_mm_sub_ps(y0, _mm_and_ps(is_j1, one_f)), _mm_set1_ps(G3));
+        __m128 z1 = _mm_add_ps(_mm_sub_ps(z0, _mm_andnot_ps(is_not_k1, one_f)), _mm_set1_ps(G3));
+        __m128 x2 = _mm_add_ps(_mm_sub_ps(x0, _mm_and_ps(is_i2, one_f)), _mm_set1_ps(2.0f * G3));
+        __m128 y2 = _mm_add_ps(_mm_sub_ps(y0, _mm_andnot_ps(is_not_j2, one_f)), _mm_set1_ps(2.0f * G3));
+        __m128 z2 = _mm_add_ps(_mm_sub_ps(z0, _mm_andnot_ps(is_not_k2, one_f)), _mm_set1_ps(2.0f * G3));
+        __m128 x3 = _mm_add_ps(_mm_sub_ps(x0, one_f), _mm_set1_ps(3.0f * G3));
+        __m128 y3 = _mm_add_ps(_mm_sub_ps(y0, one_f), _mm_set1_ps(3.0f * G3));
+        __m128 z3 = _mm_add_ps(_mm_sub_ps(z0, one_f), _mm_set1_ps(3.0f * G3));
+
+        __m128i one = _mm_set1_epi32(1);
+        __m128i i1 = _mm_and_si128(_mm_castps_si128(is_i1), one);
+        __m128i j1 = _mm_and_si128(_mm_castps_si128(is_j1), one);
+        __m128i k1 = _mm_andnot_si128(_mm_castps_si128(is_not_k1), one);
+        __m128i i2 = _mm_and_si128(_mm_castps_si128(is_i2), one);
+        __m128i j2 = _mm_andnot_si128(_mm_castps_si128(is_not_j2), one);
+        __m128i k2 = _mm_andnot_si128(_mm_castps_si128(is_not_k2), one);
+        __m128i gi0 = simplex_hash_3d_sse41(folded_seed, i, j, k);
+        __m128i gi1 = simplex_hash_3d_sse41(folded_seed, _mm_add_epi32(i, i1), _mm_add_epi32(j, j1), _mm_add_epi32(k, k1));
+        __m128i gi2 = simplex_hash_3d_sse41(folded_seed, _mm_add_epi32(i, i2), _mm_add_epi32(j, j2), _mm_add_epi32(k, k2));
+        __m128i gi3 = simplex_hash_3d_sse41(folded_seed, _mm_add_epi32(i, one), _mm_add_epi32(j, one), _mm_add_epi32(k, one));
+
+        __m128 n0 = simplex_corner_3d_sse41(x0, y0, z0, gi0);
+        __m128 n1 = simplex_corner_3d_sse41(x1, y1, z1, gi1);
+        __m128 n2 = simplex_corner_3d_sse41(x2, y2, z2, gi2);
+        __m128 n3 = simplex_corner_3d_sse41(x3, y3, z3, gi3);
+
+        __m128 result = _mm_mul_ps(_mm_set1_ps(32.0f), _mm_add_ps(_mm_add_ps(_mm_add_ps(n0, n1), n2), n3));
+        _mm_storeu_ps(out_values + idx, result);
+    }
+}
+
+SIMPLEX_TARGET_AVX2
+static inline __m256 simplex_corner_avx2(__m256 x, __m256 y, __m256i hash) {
+    __m256 t = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(0.5f), _mm256_mul_ps(x, x)), _mm256_mul_ps(y, y));
+    __m256 is_outside = _mm256_cmp_ps(t, _mm256_setzero_ps(), _CMP_LT_OQ);
+
+    __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(0x3F));
+    __m256 h_below_4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+    __m256 u = _mm256_blendv_ps(y, x, h_below_4);
+    __m256 v = _mm256_blendv_ps(x, y, h_below_4);
+    __m256 u_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31));
+    __m256 v_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+    __m256 grad = _mm256_add_ps(_mm256_xor_ps(u, u_sign), _mm256_xor_ps(_mm256_mul_ps(_mm256_set1_ps(2.0f), v), v_sign));
+
+    t = _mm256_mul_ps(t, t);
+    __m256 n = _mm256_mul_ps(_mm256_mul_ps(t, t), grad);
+    return _mm256_andnot_ps(is_outside, n);
+}
+
+SIMPLEX_TARGET_AVX2
+static inline __m256i simplex_fastfloor_avx2(__m256 x) {
+    __m256i i = _mm256_cvttps_epi32(x);
+    __m256 is_below = _mm256_cmp_ps(x, _mm256_cvtepi32_ps(i), _CMP_LT_OQ);
+    return _mm256_add_epi32(i, _mm256_castps_si256(is_below));
+}
+
+SIMPLEX_TARGET_AVX2
+static inline __m256i simplex_hash_avx2(__m256i folded_seed, __m256i i, __m256i j) {
+    __m256i hash = _mm256_xor_si256(folded_seed, _mm256_mullo_epi32(i, _mm256_set1_epi32((i32)HASH_PRIME_X)));
+    hash = _mm256_xor_si256(hash, _mm256_mullo_epi32(j, _mm256_set1_epi32((i32)HASH_PRIME_Y)));
+    hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32((i32)HASH_MULTIPLIER));
+    return _mm256_srli_epi32(hash, 26);
+}
+
+SIMPLEX_TARGET_AVX2
+static void simplex_noise_2d_avx2(u64 seed, f32* xs, f32* ys, f32* out_values, usize count) {
+    __m256i folded_seed = _mm256_set1_epi32((i32)fold_seed(seed));
+    for (usize idx = 0; idx + 8 <= count; idx += 8) {
+        __m256 x = _mm256_loadu_ps(xs + idx);
+        __m256 y = _mm256_loadu_ps(ys + idx);
+
+        __m256 s = _mm256_mul_ps(_mm256_add_ps(x, y), _mm256_set1_ps(F2));
+        __m256i i = simplex_fastfloor_avx2(_mm256_add_ps(x, s));
+        __m256i j = simplex_fastfloor_avx2(_mm256_add_ps(y, s));
+
+        __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(i, j)), _mm256_set1_ps(G2));
+        __m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(_mm256_cvtepi32_ps(i), t));
+        __m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(_mm256_cvtepi32_ps(j), t));
+
+        __m256 second_is_x = _mm256_cmp_ps(x0, y0, _CMP_GT_OQ);
+        __m256 i1 = _mm256_and_ps(second_is_x, _mm256_set1_ps(1.0f));
+        __m256 j1 = _mm256_andnot_ps(second_is_x, _mm256_set1_ps(1.0f));
+
+        __m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, i1), _mm256_set1_ps(G2));
+        __m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, j1), _mm256_set1_ps(G2));
+        __m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_set1_ps(1.0f)), _mm256_set1_ps(2.0f * G2));
+        __m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_set1_ps(1.0f)), _mm256_set1_ps(2.0f * G2));
+
+        __m256i one = _mm256_set1_epi32(1);
+        __m256i i1_int = _mm256_srli_epi32(_mm256_castps_si256(second_is_x), 31);
+        __m256i j1_int = _mm256_xor_si256(i1_int, one);
+        __m256i gi0 = simplex_hash_avx2(folded_seed, i, j);
+        __m256i gi1 = simplex_hash_avx2(folded_seed, _mm256_add_epi32(i, i1_int), _mm256_add_epi32(j, j1_int));
+        __m256i gi2 = simplex_hash_avx2(folded_seed, _mm256_add_epi32(i, one), _mm256_add_epi32(j, one));
+
+        __m256 n0 = simplex_corner_avx2(x0, y0, gi0);
+        __m256 n1 = simplex_corner_avx2(x1, y1, gi1);
+        __m256 n2 = simplex_corner_avx2(x2, y2, gi2);
+
+        __m256 result = _mm256_mul_ps(_mm256_set1_ps(45.23065f), _mm256_add_ps(_mm256_add_ps(n0, n1), n2));
+        _mm256_storeu_ps(out_values + idx, result);
+    }
+}
+
+SIMPLEX_TARGET_AVX2
+static inline __m256 simplex_corner_3d_avx2(__m256 x, __m256 y, __m256 z, __m256i hash) {
+    __m256 t = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(0.6f), _mm256_mul_ps(x, x)), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+    __m256 is_outside = _mm256_cmp_ps(t, _mm256_setzero_ps(), _CMP_LT_OQ);
+
+    __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+    __m256 h_below_8 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), h));
+    __m256 h_below_4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+    __m256 h_is_12_or_14 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_or_si256(h, _mm256_set1_epi32(2)), _mm256_set1_epi32(14)));
+    __m256 u = _mm256_blendv_ps(y, x, h_below_8);
+    __m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, h_is_12_or_14), y, h_below_4);
+    __m256 u_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31));
+    __m256 v_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+    __m256 grad = _mm256_add_ps(_mm256_xor_ps(u, u_sign), _mm256_xor_ps(v, v_sign));
+
+    t = _mm256_mul_ps(t, t);
+    __m256 n = _mm256_mul_ps(_mm256_mul_ps(t, t), grad);
+    return _mm256_andnot_ps(is_outside, n);
+}
+
+SIMPLEX_TARGET_AVX2
+static inline __m256i simplex_hash_3d_avx2(__m256i folded_seed, __m256i i, __m256i j, __m256i k) {
+    __m256i hash = _mm256_xor_si256(folded_seed, _mm256_mullo_epi32(i, _mm256_set1_epi32((i32)HASH_PRIME_X)));
+    hash = _mm256_xor_si256(hash, _mm256_mullo_epi32(j, _mm256_set1_epi32((i32)HASH_PRIME_Y)));
+    hash = _mm256_xor_si256(hash, _mm256_mullo_epi32(k, _mm256_set1_epi32((i32)HASH_PRIME_Z)));
+    hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32((i32)HASH_MULTIPLIER));
+    return _mm256_srli_epi32(hash, 28);
+}
+
+SIMPLEX_TARGET_AVX2
+static void simplex_noise_3d_avx2(u64 seed, f32* xs, f32* ys, f32* zs, f32* out_values, usize count) {
+    __m256i folded_seed = _mm256_set1_epi32((i32)fold_seed(seed));
+    for (usize idx = 0; idx + 8 <= count; idx += 8) {
+        __m256 x = _mm256_loadu_ps(xs + idx);
+        __m256 y = _mm256_loadu_ps(ys + idx);
+        __m256 z = _mm256_loadu_ps(zs + idx);
+
+        __m256 s = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), _mm256_set1_ps(F3));
+        __m256i i = simplex_fastfloor_avx2(_mm256_add_ps(x, s));
+        __m256i j = simplex_fastfloor_avx2(_mm256_add_ps(y, s));
+        __m256i k = simplex_fastfloor_avx2(_mm256_add_ps(z, s));
+
+        __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_add_epi32(i, j), k)), _mm256_set1_ps(G3));
+        __m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(_mm256_cvtepi32_ps(i), t));
+        __m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(_mm256_cvtepi32_ps(j), t));
+        __m256 z0 = _mm256_sub_ps(z, _mm256_sub_ps(_mm256_cvtepi32_ps(k), t));
+
+        __m256 xy = _mm256_cmp_ps(x0, y0, _CMP_GE_OQ);
+        __m256 xz = _mm256_cmp_ps(x0, z0, _CMP_GE_OQ);
+        __m256 yz = _mm256_cmp_ps(y0, z0, _CMP_GE_OQ);
+        __m256 is_i1 = _mm256_and_ps(xy, xz);
+        __m256 is_j1 = _mm256_andnot_ps(xy, yz);
+        __m256 is_not_k1 = _mm256_or_ps(xz, yz);
+        __m256 is_i2 = _mm256_or_ps(xy, xz);
+        __m256 is_not_j2 = _mm256_andnot_ps(yz, xy);
+        __m256 is_not_k2 = _mm256_and_ps(xz, yz);
+
+        __m256 one_f = _mm256_set1_ps(1.0f);
+        __m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_and_ps(is_i1, one_f)), _mm256_set1_ps(G3));
+        __m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_and_ps(is_j1, one_f)), _mm256_set1_ps(G3));
+        __m256 z1 = _mm256_add_ps(_mm256_sub_ps(z0, _mm256_andnot_ps(is_not_k1, one_f)), _mm256_set1_ps(G3));
+        __m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_and_ps(is_i2, one_f)), _mm256_set1_ps(2.0f * G3));
+        __m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_andnot_ps(is_not_j2, one_f)), _mm256_set1_ps(2.0f * G3));
+        __m256 z2 = _mm256_add_ps(_mm256_sub_ps(z0, _mm256_andnot_ps(is_not_k2, one_f)), _mm256_set1_ps(2.0f * G3));
+        __m256 x3 = _mm256_add_ps(_mm256_sub_ps(x0, one_f), _mm256_set1_ps(3.0f * G3));
+        __m256 y3 = _mm256_add_ps(_mm256_sub_ps(y0, one_f), _mm256_set1_ps(3.0f * G3));
+        __m256 z3 = _mm256_add_ps(_mm256_sub_ps(z0, one_f), _mm256_set1_ps(3.0f * G3));
+
+        __m256i one = _mm256_set1_epi32(1);
+        __m256i i1 = _mm256_and_si256(_mm256_castps_si256(is_i1), one);
+        __m256i j1 = _mm256_and_si256(_mm256_castps_si256(is_j1), one);
+        __m256i k1 = _mm256_andnot_si256(_mm256_castps_si256(is_not_k1), one);
+        __m256i i2 = _mm256_and_si256(_mm256_castps_si256(is_i2), one);
+        __m256i j2 = _mm256_andnot_si256(_mm256_castps_si256(is_not_j2), one);
+        __m256i k2 = _mm256_andnot_si256(_mm256_castps_si256(is_not_k2), one);
+        __m256i gi0 = simplex_hash_3d_avx2(folded_seed, i, j, k);
+        __m256i gi1 = simplex_hash_3d_avx2(folded_seed, _mm256_add_epi32(i, i1), _mm256_add_epi32(j, j1), _mm256_add_epi32(k, k1));
+        __m256i gi2 = simplex_hash_3d_avx2(folded_seed, _mm256_add_epi32(i, i2), _mm256_add_epi32(j, j2), _mm256_add_epi32(k, k2));
+        __m256i gi3 = simplex_hash_3d_avx2(folded_seed, _mm256_add_epi32(i, one), _mm256_add_epi32(j, one), _mm256_add_epi32(k, one));
+
+        __m256 n0 = simplex_corner_3d_avx2(x0, y0, z0, gi0);
+        __m256 n1 = simplex_corner_3d_avx2(x1, y1, z1, gi1);
+        __m256 n2 = simplex_corner_3d_avx2(x2, y2, z2, gi2);
+        __m256 n3 = simplex_corner_3d_avx2(x3, y3, z3, gi3);
+
+        __m256 result = _mm256_mul_ps(_mm256_set1_ps(32.0f), _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(n0, n1), n2), n3));
+        _mm256_storeu_ps(out_values + idx, result);
+    }
+}
+
+// NOTE: AVX-512F alone has no float and/xor (that's AVX-512DQ), so the
+// masks are applied with masked moves, and the sign flips are done on ints.
+SIMPLEX_TARGET_AVX512
+static inline __m512 simplex_corner_avx512(__m512 x, __m512 y, __m512i hash) {
+    __m512 t = _mm512_sub_ps(_mm512_sub_ps(_mm512_set1_ps(0.5f), _mm512_mul_ps(x, x)), _mm512_mul_ps(y, y));
+    __mmask16 is_inside = _mm512_cmp_ps_mask(t, _mm512_setzero_ps(), _CMP_NLT_UQ);
+
+    __m512i h = _mm512_and_si512(hash, _mm512_set1_epi32(0x3F));
+    __mmask16 h_below_4 = _mm512_cmplt_epi32_mask(h, _mm512_set1_epi32(4));
+    __m512 u = _mm512_mask_blend_ps(h_below_4, y, x);
+    __m512 v = _mm512_mask_blend_ps(h_below_4, x, y);
+    __m512i u_sign = _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(1)), 31);
+    __m512i v_sign = _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(2)), 30);
+    __m512 signed_u = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(u), u_sign));
+    __m512 signed_v = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(_mm512_mul_ps(_mm512_set1_ps(2.0f), v)), v_sign));
+    __m512 grad = _mm512_add_ps(signed_u, signed_v);
+
+    t = _mm512_mul_ps(t, t);
+    __m512 n = _mm512_mul_ps(_mm512_mul_ps(t, t), grad);
+    return _mm512_maskz_mov_ps(is_inside, n);
+}
+
+SIMPLEX_TARGET_AVX512
+static inline __m512i simplex_fastfloor_avx512(__m512 x) {
+    __m512i i = _mm512_cvttps_epi32(x);
+    __mmask16 is_below = _mm512_cmp_ps_mask(x, _mm512_cvtepi32_ps(i), _CMP_LT_OQ);
+    return _mm512_mask_sub_epi32(i, is_below, i, _mm512_set1_epi32(1));
+}
+
+SIMPLEX_TARGET_AVX512
+static inline __m512i simplex_hash_avx512(__m512i folded_seed, __m512i i, __m512i j) {
+    __m512i hash = _mm512_xor_si512(folded_seed, _mm512_mullo_epi32(i, _mm512_set1_epi32((i32)HASH_PRIME_X)));
+    hash = _mm512_xor_si512(hash, _mm512_mullo_epi32(j, _mm512_set1_epi32((i32)HASH_PRIME_Y)));
+    hash = _mm512_mullo_epi32(hash, _mm512_set1_epi32((i32)HASH_MULTIPLIER));
+    return _mm512_srli_epi32(hash, 26);
+}
+
+SIMPLEX_TARGET_AVX512
+static void simplex_noise_2d_avx512(u64 seed, f32* xs, f32* ys, f32* out_values, usize count) {
+    __m512i folded_seed = _mm512_set1_epi32((i32)fold_seed(seed));
+    for (usize idx = 0; idx + 16 <= count; idx += 16) {
+        __m512 x = _mm512_loadu_ps(xs + idx);
+        __m512 y = _mm512_loadu_ps(ys + idx);
+
+        __m512 s = _mm512_mul_ps(_mm512_add_ps(x, y), _mm512_set1_ps(F2));
+        __m512i i = simplex_fastfloor_avx512(_mm512_add_ps(x, s));
+        __m512i j = simplex_fastfloor_avx512(_mm512_add_ps(y, s));
+
+        __m512 t = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_add_epi32(i, j)), _mm512_set1_ps(G2));
+        __m512 x0 = _mm512_sub_ps(x, _mm512_sub_ps(_mm512_cvtepi32_ps(i), t));
+        __m512 y0 = _mm512_sub_ps(y, _mm512_sub_ps(_mm512_cvtepi32_ps(j), t));
+
+        __mmask16 second_is_x = _mm512_cmp_ps_mask(x0, y0, _CMP_GT_OQ);
+        __m512 i1 = _mm512_maskz_mov_ps(second_is_x, _mm512_set1_ps(1.0f));
+        __m512 j1 = _mm512_maskz_mov_ps(_mm512_knot(second_is_x), _mm512_set1_ps(1.0f));
+
+        __m512 x1 = _mm512_add_ps(_mm512_sub_ps(x0, i1), _mm512_set1_ps(G2));
+        __m512 y1 = _mm512_add_ps(_mm512_sub_ps(y0, j1), _mm512_set1_ps(G2));
+        __m512 x2 = _mm512_add_ps(_mm512_sub_ps(x0, _mm512_set1_ps(1.0f)), _mm512_set1_ps(2.0f * G2));
+        __m512 y2 = _mm512_add_ps(_mm512_sub_ps(y0, _mm512_set1_ps(1.0f)), _mm512_set1_ps(2.0f * G2));
+
+        __m512i one = _mm512_set1_epi32(1);
+        __m512i i1_int = _mm512_maskz_mov_epi32(second_is_x, one);
+        __m512i j1_int = _mm512_maskz_mov_epi32(_mm512_knot(second_is_x), one);
+        __m512i gi0 = simplex_hash_avx512(folded_seed, i, j);
+        __m512i gi1 = simplex_hash_avx512(folded_seed, _mm512_add_epi32(i, i1_int), _mm512_add_epi32(j, j1_int));
+        __m512i gi2 = simplex_hash_avx512(folded_seed, _mm512_add_epi32(i, one), _mm512_add_epi32(j, one));
+
+        __m512 n0 = simplex_corner_avx512(x0, y0, gi0);
+        __m512 n1 = simplex_corner_avx512(x1, y1, gi1);
+        __m512 n2 = simplex_corner_avx512(x2, y2, gi2);
+
+        __m512 result = _mm512_mul_ps(_mm512_set1_ps(45.23065f), _mm512_add_ps(_mm512_add_ps(n0, n1), n2));
+        _mm512_storeu_ps(out_values + idx, result);
+    }
+}
+
+SIMPLEX_TARGET_AVX512
+static inline __m512 simplex_corner_3d_avx512(__m512 x, __m512 y, __m512 z, __m512i hash) {
+    __m512 t = _mm512_sub_ps(_mm512_sub_ps(_mm512_sub_ps(_mm512_set1_ps(0.6f), _mm512_mul_ps(x, x)), _mm512_mul_ps(y, y)), _mm512_mul_ps(z, z));
+    __mmask16 is_inside = _mm512_cmp_ps_mask(t, _mm512_setzero_ps(), _CMP_NLT_UQ);
+
+    __m512i h = _mm512_and_si512(hash, _mm512_set1_epi32(15));
+    __mmask16 h_below_8 = _mm512_cmplt_epi32_mask(h, _mm512_set1_epi32(8));
+    __mmask16 h_below_4 = _mm512_cmplt_epi32_mask(h, _mm512_set1_epi32(4));
+    __mmask16 h_is_12_or_14 = _mm512_cmpeq_epi32_mask(_mm512_or_si512(h, _mm512_set1_epi32(2)), _mm512_set1_epi32(14));
+    __m512 u = _mm512_mask_blend_ps(h_below_8, y, x);
+    __m512 v = _mm512_mask_blend_ps(h_below_4, _mm512_mask_blend_ps(h_is_12_or_14, z, x), y);
+    __m512i u_sign = _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(1)), 31);
+    __m512i v_sign = _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(2)), 30);
+    __m512 signed_u = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(u), u_sign));
+    __m512 signed_v = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(v), v_sign));
+    __m512 grad = _mm512_add_ps(signed_u, signed_v);
+
+    t = _mm512_mul_ps(t, t);
+    __m512 n = _mm512_mul_ps(_mm512_mul_ps(t, t), grad);
+    return _mm512_maskz_mov_ps(is_inside, n);
+}
+
+SIMPLEX_TARGET_AVX512
+static inline __m512i simplex_hash_3d_avx512(__m512i folded_seed, __m512i i, __m512i j, __m512i k) {
+    __m512i hash = _mm512_xor_si512(folded_seed, _mm512_mullo_epi32(i, _mm512_set1_epi32((i32)HASH_PRIME_X)));
+    hash = _mm512_xor_si512(hash, _mm512_mullo_epi32(j, _mm512_set1_epi32((i32)HASH_PRIME_Y)));
+    hash = _mm512_xor_si512(hash, _mm512_mullo_epi32(k, _mm512_set1_epi32((i32)HASH_PRIME_Z)));
+    hash = _mm512_mullo_epi32(hash, _mm512_set1_epi32((i32)HASH_MULTIPLIER));
+    return _mm512_srli_epi32(hash, 28);
+}
+
+SIMPLEX_TARGET_AVX512
+static void simplex_noise_3d_avx512(u64 seed, f32* xs, f32* ys, f32* zs, f32* out_values, usize count) {
+    __m512i folded_seed = _mm512_set1_epi32((i32)fold_seed(seed));
+    for (usize idx = 0; idx + 16 <= count; idx += 16) {
+        __m512 x = _mm512_loadu_ps(xs + idx);
+        __m512 y = _mm512_loadu_ps(ys + idx);
+        __m512 z = _mm512_loadu_ps(zs + idx);
+
+        __m512 s = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(x, y), z), _mm512_set1_ps(F3));
+        __m512i i = simplex_fastfloor_avx512(_mm512_add_ps(x, s));
+        __m512i j = simplex_fastfloor_avx512(_mm512_add_ps(y, s));
+        __m512i k = simplex_fastfloor_avx512(_mm512_add_ps(z, s));
+
+        __m512 t = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_add_epi32(_mm512_add_epi32(i, j), k)), _mm512_set1_ps(G3));
+        __m512 x0 = _mm512_sub_ps(x, _mm512_sub_ps(_mm512_cvtepi32_ps(i), t));
+        __m512 y0 = _mm512_sub_ps(y, _mm512_sub_ps(_mm512_cvtepi32_ps(j), t));
+        __m512 z0 = _mm512_sub_ps(z, _mm512_sub_ps(_mm512_cvtepi32_ps(k), t));
+
+        __mmask16 xy = _mm512_cmp_ps_mask(x0, y0, _CMP_GE_OQ);
+        __mmask16 xz = _mm512_cmp_ps_mask(x0, z0, _CMP_GE_OQ);
+        __mmask16 yz = _mm512_cmp_ps_mask(y0, z0, _CMP_GE_OQ);
+        __mmask16 is_i1 = _mm512_kand(xy, xz);
+        __mmask16 is_j1 = _mm512_kandn(xy, yz);
+        __mmask16 is_k1 = _mm512_knot(_mm512_kor(xz, yz));
+        __mmask16 is_i2 = _mm512_kor(xy, xz);
+        __mmask16 is_j2 = _mm512_knot(_mm512_kandn(yz, xy));
+        __mmask16 is_k2 = _mm512_knot(_mm512_kand(xz, yz));
+
+        __m512 one_f = _mm512_set1_ps(1.0f);
+        __m512 x1 = _mm512_add_ps(_mm512_sub_ps(x0, _mm512_maskz_mov_ps(is_i1, one_f)), _mm512_set1_ps(G3));
+        __m512 y1 = _mm512_add_ps(_mm512_sub_ps(y0, _mm512_maskz_mov_ps(is_j1, one_f)), _mm512_set1_ps(G3));
+        __m512 z1 = _mm512_add_ps(_mm512_sub_ps(z0, _mm512_maskz_mov_ps(is_k1, one_f)), _mm512_set1_ps(G3));
+        __m512 x2 = _mm512_add_ps(_mm512_sub_ps(x0, _mm512_maskz_mov_ps(is_i2, one_f)), _mm512_set1_ps(2.0f * G3));
+        __m512 y2 = _mm512_add_ps(_mm512_sub_ps(y0, _mm512_maskz_mov_ps(is_j2, one_f)), _mm512_set1_ps(2.0f * G3));
+        __m512 z2 = _mm512_add_ps(_mm512_sub_ps(z0, _mm512_maskz_mov_ps(is_k2, one_f)), _mm512_set1_ps(2.0f * G3));
+        __m512 x3 = _mm512_add_ps(_mm512_sub_ps(x0, one_f), _mm512_set1_ps(3.0f * G3));
+        __m512 y3 = _mm512_add_ps(_mm512_sub_ps(y0, one_f), _mm512_set1_ps(3.0f * G3));
+        __m512 z3 = _mm512_add_ps(_mm512_sub_ps(z0, one_f), _mm512_set1_ps(3.0f * G3));
+
+        __m512i one = _mm512_set1_epi32(1);
+        __m512i gi0 = simplex_hash_3d_avx512(folded_seed, i, j, k);
+        __m512i gi1 = simplex_hash_3d_avx512(folded_seed, _mm512_mask_add_epi32(i, is_i1, i, one), _mm512_mask_add_epi32(j, is_j1, j, one), _mm512_mask_add_epi32(k, is_k1, k, one));
+        __m512i gi2 = simplex_hash_3d_avx512(folded_seed, _mm512_mask_add_epi32(i, is_i2, i, one), _mm512_mask_add_epi32(j, is_j2, j, one), _mm512_mask_add_epi32(k, is_k2, k, one));
+        __m512i gi3 = simplex_hash_3d_avx512(folded_seed, _mm512_add_epi32(i, one), _mm512_add_epi32(j, one), _mm512_add_epi32(k, one));
+
+        __m512 n0 = simplex_corner_3d_avx512(x0, y0, z0, gi0);
+        __m512 n1 = simplex_corner_3d_avx512(x1, y1, z1, gi1);
+        __m512 n2 = simplex_corner_3d_avx512(x2, y2, z2, gi2);
+        __m512 n3 = simplex_corner_3d_avx512(x3, y3, z3, gi3);
+
+        __m512 result = _mm512_mul_ps(_mm512_set1_ps(32.0f), _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(n0, n1), n2), n3));
+        _mm512_storeu_ps(out_values + idx, result);
+    }
+}
+
+// NOTE: The OS also has to save the wider registers on context switches,
+// which it tells through XCR0.
+static u64 read_xcr0() {
+    u32 lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((u64)hi << 32) | lo;
+}
+
+// NOTE: Returns the lane counts of the paths the CPU supports, or'ed
+// together. They are all powers of two, so each one is its own bit.
+static u32 detect_simplex_supported_lanes() {
+    u32 eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return 1;
+
+    b32 has_sse41 = (ecx & bit_SSE4_1) != 0;
+    b32 has_osxsave = (ecx & bit_OSXSAVE) != 0;
+    u64 xcr0 = has_osxsave ? read_xcr0() : 0;
+    b32 os_saves_avx = (xcr0 & 0x6) == 0x6;
+    b32 os_saves_avx512 = (xcr0 & 0xE6) == 0xE6;
+
+    b32 has_avx2 = false;
+    b32 has_avx512f = false;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        has_avx2 = (ebx & bit_AVX2) != 0;
+        has_avx512f = (ebx & bit_AVX512F) != 0;
+    }
+
+    u32 supported_lanes = 1;
+    if (has_sse41) supported_lanes |= 4;
+    if (has_avx2 && os_saves_avx) supported_lanes |= 8;
+    if (has_avx512f && os_saves_avx512) supported_lanes |= 16;
+    return supported_lanes;
+}
+
+// NOTE: Zero until the dispatch is initialized.
+static u32 simplex_supported_lanes = 0;
+static u32 simplex_batch_lanes = 0;
+
+void simplex_noise_init_dispatch() {
+    simplex_supported_lanes = detect_simplex_supported_lanes();
+
+    // NOTE: The widest path.
+    simplex_batch_lanes = 16;
+    while (!(simplex_supported_lanes & simplex_batch_lanes)) {
+        simplex_batch_lanes /= 2;
+    }
+}
+
+b32 simplex_noise_set_batch_lanes(u32 lanes) {
+    ASSERT(simplex_supported_lanes != 0);
+    if (lanes != 1 && lanes != 4 && lanes != 8 && lanes != 16) return false;
+    if (!(simplex_supported_lanes & lanes)) return false;
+
+    simplex_batch_lanes = lanes;
+    return true;
+}
+
+u32 simplex_noise_batch_lanes() {
+    ASSERT(simplex_batch_lanes != 0);
+    return simplex_batch_lanes;
+}
+
+void simplex_noise_2d_batch(u64 seed, f32* xs, f32* ys, f32* out_values, usize count) {
+    u32 lanes = simplex_noise_batch_lanes();
+    switch (lanes) {
+        case 16: simplex_noise_2d_avx512(seed, xs, ys, out_values, count); break;
+        case 8: simplex_noise_2d_avx2(seed, xs, ys, out_values, count); break;
+        case 4: simplex_noise_2d_sse41(seed, xs, ys, out_values, count); break;
+        default: break;
+    }
+
+    // NOTE: The points that don't fill a whole register.
+    usize vectorized_count = lanes > 1 ? count - count % lanes : 0;
+    for (usize idx = vectorized_count; idx < count; idx++) {
+        out_values[idx] = simplex_noise_2d(seed, xs[idx], ys[idx]);
+    }
+}
+
+void simplex_noise_3d_batch(u64 seed, f32* xs, f32* ys, f32* zs, f32* out_values, usize count) {
+    u32 lanes = simplex_noise_batch_lanes();
+    switch (lanes) {
+        case 16: simplex_noise_3d_avx512(seed, xs, ys, zs, out_values, count); break;
+        case 8: simplex_noise_3d_avx2(seed, xs, ys, zs, out_values, count); break;
+        case 4: simplex_noise_3d_sse41(seed, xs, ys, zs, out_values, count); break;
+        default: break;
+    }
+
+    usize vectorized_count = lanes > 1 ? count - count % lanes : 0;
+    for (usize idx = vectorized_count; idx < count; idx++) {
+        out_values[idx] = simplex_noise_3d(seed, xs[idx], ys[idx], zs[idx]);
+    }
+}
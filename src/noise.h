@@ -2,10 +2,26 @@
 
 #include "common.h"
 
-struct SimplexTable {
-    u8 permutations[256];
-};
+// NOTE: The seed is used directly, there is nothing to initialize.
+f32 simplex_noise_2d(u64 seed, f32 x, f32 y);
+f32 simplex_noise_3d(u64 seed, f32 x, f32 y, f32 z);
 
-void simplex_table_from_seed(SimplexTable* to_init, u64 seed);
+// NOTE: Evaluates count points at once, using the widest SIMD path the CPU
+// supports (SSE4.1, AVX2 or AVX-512, picked by simplex_noise_init_dispatch).
+// The result is bit-for-bit the same as the scalar versions: the operations
+// are done in the same order, and the corner branches are replaced by masks.
+void simplex_noise_2d_batch(u64 seed, f32* xs, f32* ys, f32* out_values, usize count);
+void simplex_noise_3d_batch(u64 seed, f32* xs, f32* ys, f32* zs, f32* out_values, usize count);
 
-f32 simplex_noise_2d(SimplexTable* simplex_table, f32 x, f32 y);
+// NOTE: Picks the SIMD path of the batches from what the CPU supports. It has
+// to be called once before using the batches, and before any thread does.
+void simplex_noise_init_dispatch();
+
+// NOTE: How many points the selected SIMD path evaluates at once (1 if the
+// scalar version is used). The 2D and 3D batches use the same path.
+u32 simplex_noise_batch_lanes();
+
+// NOTE: For testing the paths against each other: the batches use the path
+// with that many lanes (1, 4, 8 or 16) instead. Returns false and changes
+// nothing if the CPU doesn't support it.
+b32 simplex_noise_set_batch_lanes(u32 lanes);
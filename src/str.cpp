@@ -236,6 +236,13 @@ StrView formatStringVAList(Slice<u8> buffer, StrView fmt, va_list args_list) {
                     usize val = va_arg(args_list, usize);
                     outputSize(output, val);
                 }
+                else if (code == "str") {
+                    const char* val = va_arg(args_list, const char*);
+                    while (*val) {
+                        outputChar(output, *val);
+                        val++;
+                    }
+                }
             } break;
 
             default: {
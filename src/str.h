@@ -7,4 +7,5 @@
 // - {(u|i)(32|64)} -> for the corresponding integers
 // - {f(32|64)} -> for floating point types
 // - {size} -> prints a size_t as an actual memory size, i.e. "64 KB" or "4 MB"
+// - {str} -> for null-terminated C strings
 StrView formatString(Slice<u8> buffer, StrView fmt, ...);
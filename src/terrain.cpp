@@ -0,0 +1,453 @@
+#include <emmintrin.h>
+
+#include "terrain.h"
+#include "noise.h"
+
+// NOTE: The material pass, for a row of 16 blocks along X. Blocks with a
+// negative depth are air, the others get their type from the depth
+// thresholds. It's branchless, 4 blocks at a time with SSE2: every threshold
+// is a comparison mask that selects its type over the previous one, and the
+// 32-bit types are packed down to bytes at the end.
+static void assignBlockTypesRow(__m128 depths[4], i64 block_y, u8* out_row) {
+    static_assert(CHUNK_W == 16, "The material pass packs 16 blocks per row.");
+
+    u8 surface_block = (f32)block_y >= TERRAIN_SNOW_HEIGHT ? BLOCK_SNOW : BLOCK_GRASS;
+    __m128i surface_type = _mm_set1_epi32(surface_block);
+    __m128i dirt_type = _mm_set1_epi32(BLOCK_DIRT);
+    __m128i stone_type = _mm_set1_epi32(BLOCK_STONE);
+    __m128 dirt_depth = _mm_set1_ps(TERRAIN_DIRT_DEPTH);
+    __m128 stone_depth = _mm_set1_ps(TERRAIN_STONE_DEPTH);
+
+    __m128i types[4];
+    for (u32 i = 0; i < 4; i++) {
+        __m128 depth = depths[i];
+        __m128i is_solid = _mm_castps_si128(_mm_cmpge_ps(depth, _mm_setzero_ps()));
+        __m128i is_dirt = _mm_castps_si128(_mm_cmpge_ps(depth, dirt_depth));
+        __m128i is_stone = _mm_castps_si128(_mm_cmpge_ps(depth, stone_depth));
+
+        __m128i type = _mm_and_si128(is_solid, surface_type);
+        type = _mm_or_si128(_mm_and_si128(is_dirt, dirt_type), _mm_andnot_si128(is_dirt, type));
+        type = _mm_or_si128(_mm_and_si128(is_stone, stone_type), _mm_andnot_si128(is_stone, type));
+        types[i] = type;
+    }
+
+    __m128i packed = _mm_packus_epi16(_mm_packs_epi32(types[0], types[1]), _mm_packs_epi32(types[2], types[3]));
+    _mm_storeu_si128((__m128i*)out_row, packed);
+}
+
+// NOTE: Adds one octave of noise to the heightmap. A whole row of the
+// heightmap goes through the SIMD noise at once.
+static void accumulateHeightmapOctave(u64 seed, f32 frequency, f32 amplitude, i32 chunk_x, i32 chunk_z, ChunkHeightmap* heightmap) {
+    for (i32 z = 0; z < CHUNK_W; z++) {
+        f32 xs[CHUNK_W];
+        f32 ys[CHUNK_W];
+        f32 noise[CHUNK_W];
+        for (i32 x = 0; x < CHUNK_W; x++) {
+            i64 block_x = (i64)chunk_x * CHUNK_W + x;
+            i64 block_z = (i64)chunk_z * CHUNK_W + z;
+            xs[x] = (f32)block_x * frequency;
+            ys[x] = (f32)block_z * frequency;
+        }
+
+        simplex_noise_2d_batch(seed, xs, ys, noise, CHUNK_W);
+
+        for (i32 x = 0; x < CHUNK_W; x++) {
+            #if ENGINE_SLOW
+            ASSERT(noise[x] == simplex_noise_2d(seed, xs[x], ys[x]));
+            #endif
+            heightmap->heights[x + z * CHUNK_W] += ((noise[x] + 1.f) / 2.f) * amplitude;
+        }
+    }
+}
+
+// NOTE: The preset is known at compile time, so the octave count is a
+// constant and the loop can be fully unrolled, with the frequencies and
+// amplitudes of every octave folded into constants.
+template <const TerrainDescription& PRESET>
+static void accumulatePresetHeightmapOctaves(i32 chunk_x, i32 chunk_z, ChunkHeightmap* heightmap) {
+    f32 frequency = PRESET.scale;
+    f32 amplitude = PRESET.amplitude;
+    #pragma clang loop unroll(full)
+    for (u32 octave = 0; octave < PRESET.octaves_count; octave++) {
+        accumulateHeightmapOctave(PRESET.seed, frequency, amplitude, chunk_x, chunk_z, heightmap);
+        frequency *= PRESET.lacunarity;
+        amplitude *= PRESET.gain;
+    }
+}
+
+static void accumulateHeightmapOctaves(TerrainDescription* description, i32 chunk_x, i32 chunk_z, ChunkHeightmap* heightmap) {
+    f32 frequency = description->scale;
+    f32 amplitude = description->amplitude;
+    for (u32 octave = 0; octave < description->octaves_count; octave++) {
+        accumulateHeightmapOctave(description->seed, frequency, amplitude, chunk_x, chunk_z, heightmap);
+        frequency *= description->lacunarity;
+        amplitude *= description->gain;
+    }
+}
+
+static b32 isSameTerrainDescription(TerrainDescription* a, const TerrainDescription* b) {
+    return a->kind == b->kind
+        && a->seed == b->seed
+        && a->octaves_count == b->octaves_count
+        && a->scale == b->scale
+        && a->amplitude == b->amplitude
+        && a->lacunarity == b->lacunarity
+        && a->gain == b->gain
+        && a->base_height == b->base_height
+        && a->lattice_step == b->lattice_step;
+}
+
+void generateTerrainHeightmap(TerrainDescription* description, i32 chunk_x, i32 chunk_z, ChunkHeightmap* out_heightmap) {
+    ASSERT(description->kind == TERRAIN_HEIGHTMAP);
+
+    for (i32 i = 0; i < CHUNK_W * CHUNK_W; i++) {
+        out_heightmap->heights[i] = 0;
+    }
+
+    if (isSameTerrainDescription(description, &TERRAIN_PRESET_HILLS)) {
+        accumulatePresetHeightmapOctaves<TERRAIN_PRESET_HILLS>(chunk_x, chunk_z, out_heightmap);
+    } else if (isSameTerrainDescription(description, &TERRAIN_PRESET_MOUNTAINS)) {
+        accumulatePresetHeightmapOctaves<TERRAIN_PRESET_MOUNTAINS>(chunk_x, chunk_z, out_heightmap);
+    } else {
+        accumulateHeightmapOctaves(description, chunk_x, chunk_z, out_heightmap);
+    }
+
+    out_heightmap->min_height = out_heightmap->heights[0];
+    out_heightmap->max_height = out_heightmap->heights[0];
+    for (i32 i = 1; i < CHUNK_W * CHUNK_W; i++) {
+        if (out_heightmap->heights[i] < out_heightmap->min_height) out_heightmap->min_height = out_heightmap->heights[i];
+        if (out_heightmap->heights[i] > out_heightmap->max_height) out_heightmap->max_height = out_heightmap->heights[i];
+    }
+}
+
+// NOTE: The lattice points go through the SIMD noise in batches, to keep
+// the buffers small. The last batch is rounded up to a whole number of SIMD
+// registers (the extra points just repeat the last one) so that the noise
+// never falls back to the scalar version for the tail.
+constexpr usize DENSITY_BATCH_SIZE = 256;
+
+static void accumulateDensityOctave(u64 seed, f32 frequency, f32 amplitude, v3i chunk_position, u32 step, ChunkDensityLattice* lattice) {
+    u32 points_w = lattice->points_w;
+    usize points_count = points_w * points_w * points_w;
+
+    for (usize batch_start = 0; batch_start < points_count; batch_start += DENSITY_BATCH_SIZE) {
+        usize batch_count = points_count - batch_start < DENSITY_BATCH_SIZE ? points_count - batch_start : DENSITY_BATCH_SIZE;
+        usize padded_count = (batch_count + 15) & ~(usize)15;
+
+        f32 xs[DENSITY_BATCH_SIZE];
+        f32 ys[DENSITY_BATCH_SIZE];
+        f32 zs[DENSITY_BATCH_SIZE];
+        f32 noise[DENSITY_BATCH_SIZE];
+        for (usize i = 0; i < padded_count; i++) {
+            usize idx = batch_start + (i < batch_count ? i : batch_count - 1);
+            u32 x = idx % points_w;
+            u32 y = (idx / points_w) % points_w;
+            u32 z = idx / (points_w * points_w);
+            i64 block_x = (i64)chunk_position.x() * CHUNK_W + x * step;
+            i64 block_y = (i64)chunk_position.y() * CHUNK_W + y * step;
+            i64 block_z = (i64)chunk_position.z() * CHUNK_W + z * step;
+            xs[i] = (f32)block_x * frequency;
+            ys[i] = (f32)block_y * frequency;
+            zs[i] = (f32)block_z * frequency;
+        }
+
+        simplex_noise_3d_batch(seed, xs, ys, zs, noise, padded_count);
+
+        for (usize i = 0; i < batch_count; i++) {
+            #if ENGINE_SLOW
+            ASSERT(noise[i] == simplex_noise_3d(seed, xs[i], ys[i], zs[i]));
+            #endif
+            lattice->values[batch_start + i] += noise[i] * amplitude;
+        }
+    }
+}
+
+template <const TerrainDescription& PRESET>
+static void accumulatePresetDensityOctaves(v3i chunk_position, ChunkDensityLattice* lattice) {
+    f32 frequency = PRESET.scale;
+    f32 amplitude = PRESET.amplitude;
+    #pragma clang loop unroll(full)
+    for (u32 octave = 0; octave < PRESET.octaves_count; octave++) {
+        accumulateDensityOctave(PRESET.seed, frequency, amplitude, chunk_position, PRESET.lattice_step, lattice);
+        frequency *= PRESET.lacunarity;
+        amplitude *= PRESET.gain;
+    }
+}
+
+static void accumulateDensityOctaves(TerrainDescription* description, v3i chunk_position, ChunkDensityLattice* lattice) {
+    f32 frequency = description->scale;
+    f32 amplitude = description->amplitude;
+    for (u32 octave = 0; octave < description->octaves_count; octave++) {
+        accumulateDensityOctave(description->seed, frequency, amplitude, chunk_position, description->lattice_step, lattice);
+        frequency *= description->lacunarity;
+        amplitude *= description->gain;
+    }
+}
+
+void generateTerrainDensityLattice(TerrainDescription* description, v3i chunk_position, ChunkDensityLattice* out_lattice) {
+    ASSERT(description->kind == TERRAIN_DENSITY_3D);
+
+    u32 step = description->lattice_step;
+    ASSERT(step > 0 && step <= CHUNK_W && (step & (step - 1)) == 0);
+
+    u32 points_w = CHUNK_W / step + 1;
+    out_lattice->points_w = points_w;
+
+    // NOTE: Same layout as the blocks, x first and z last.
+    usize points_count = points_w * points_w * points_w;
+    for (usize i = 0; i < points_count; i++) {
+        out_lattice->values[i] = 0;
+    }
+
+    if (isSameTerrainDescription(description, &TERRAIN_PRESET_CLIFFS)) {
+        accumulatePresetDensityOctaves<TERRAIN_PRESET_CLIFFS>(chunk_position, out_lattice);
+    } else if (isSameTerrainDescription(description, &TERRAIN_PRESET_CLIFFS_QUALITY)) {
+        accumulatePresetDensityOctaves<TERRAIN_PRESET_CLIFFS_QUALITY>(chunk_position, out_lattice);
+    } else if (isSameTerrainDescription(description, &TERRAIN_PRESET_CLIFFS_FAST)) {
+        accumulatePresetDensityOctaves<TERRAIN_PRESET_CLIFFS_FAST>(chunk_position, out_lattice);
+    } else {
+        accumulateDensityOctaves(description, chunk_position, out_lattice);
+    }
+}
+
+// NOTE: The interpolation weights only depend on the position of the block in
+// its lattice cell, so they are the same along every axis.
+void fillChunkBlocksFromDensityLattice(TerrainDescription* description, ChunkDensityLattice* lattice, i32 chunk_y, ChunkBlocks* out_blocks) {
+    u32 step = description->lattice_step;
+    u32 points_w = lattice->points_w;
+    ASSERT(points_w == CHUNK_W / step + 1);
+
+    u32 cells[CHUNK_W];
+    f32 weights[CHUNK_W];
+    for (u32 i = 0; i < CHUNK_W; i++) {
+        cells[i] = i / step;
+        weights[i] = (f32)(i % step) / (f32)step;
+    }
+
+    // NOTE: Interpolate along x first, once for every row of lattice
+    // points. Then every row of blocks only needs the y and z interpolations
+    // between 4 of these rows, which are done 4 blocks at a time and go
+    // straight to the material pass, without leaving the SSE registers.
+    f32 rows[DENSITY_LATTICE_MAX_W * DENSITY_LATTICE_MAX_W][CHUNK_W];
+    for (u32 row_idx = 0; row_idx < points_w * points_w; row_idx++) {
+        f32* points = &lattice->values[row_idx * points_w];
+        for (u32 x = 0; x < CHUNK_W; x++) {
+            f32 a = points[cells[x]];
+            f32 b = points[cells[x] + 1];
+            rows[row_idx][x] = a + (b - a) * weights[x];
+        }
+    }
+
+    for (i32 z = 0; z < CHUNK_W; z++) {
+        __m128 weight_z = _mm_set1_ps(weights[z]);
+
+        for (i32 y = 0; y < CHUNK_W; y++) {
+            __m128 weight_y = _mm_set1_ps(weights[y]);
+            i64 block_y = (i64)chunk_y * CHUNK_W + y;
+
+            // NOTE: The vertical gradient is linear, so it can be added
+            // exactly after the interpolation instead of to every sample.
+            __m128 gradient = _mm_set1_ps(description->base_height - (f32)block_y);
+
+            u32 row_idx = cells[y] + cells[z] * points_w;
+            f32* row00 = rows[row_idx];
+            f32* row10 = rows[row_idx + 1];
+            f32* row01 = rows[row_idx + points_w];
+            f32* row11 = rows[row_idx + 1 + points_w];
+
+            __m128 densities[4];
+            for (u32 i = 0; i < 4; i++) {
+                __m128 v00 = _mm_loadu_ps(&row00[i * 4]);
+                __m128 v10 = _mm_loadu_ps(&row10[i * 4]);
+                __m128 v01 = _mm_loadu_ps(&row01[i * 4]);
+                __m128 v11 = _mm_loadu_ps(&row11[i * 4]);
+                __m128 v0 = _mm_add_ps(v00, _mm_mul_ps(_mm_sub_ps(v10, v00), weight_y));
+                __m128 v1 = _mm_add_ps(v01, _mm_mul_ps(_mm_sub_ps(v11, v01), weight_y));
+                __m128 density = _mm_add_ps(v0, _mm_mul_ps(_mm_sub_ps(v1, v0), weight_z));
+                densities[i] = _mm_add_ps(density, gradient);
+            }
+
+            assignBlockTypesRow(densities, block_y, &out_blocks->data[y * CHUNK_W + z * CHUNK_W * CHUNK_W]);
+        }
+    }
+}
+
+static void heightmapCacheUnlink(HeightmapCache* cache, HeightmapCacheEntry* entry) {
+    if (entry->prev) entry->prev->next = entry->next;
+    else cache->most_recent = entry->next;
+
+    if (entry->next) entry->next->prev = entry->prev;
+    else cache->least_recent = entry->prev;
+
+    entry->prev = nullptr;
+    entry->next = nullptr;
+}
+
+// NOTE: Moves the entry to the front of the LRU list.
+static void heightmapCacheTouch(HeightmapCache* cache, HeightmapCacheEntry* entry) {
+    entry->next = cache->most_recent;
+    if (cache->most_recent) cache->most_recent->prev = entry;
+    cache->most_recent = entry;
+    if (!cache->least_recent) cache->least_recent = entry;
+}
+
+ChunkHeightmap* findCachedChunkHeightmap(HeightmapCache* cache, i32 chunk_x, i32 chunk_z) {
+    HeightmapCacheEntry* entry = hashmapGet(&cache->hashmap, v2i {chunk_x, chunk_z});
+    if (entry == nullptr) {
+        cache->misses_count++;
+        return nullptr;
+    }
+
+    cache->hits_count++;
+    heightmapCacheUnlink(cache, entry);
+    heightmapCacheTouch(cache, entry);
+    return &entry->heightmap;
+}
+
+ChunkHeightmap* insertCachedChunkHeightmap(HeightmapCache* cache, i32 chunk_x, i32 chunk_z, ChunkHeightmap* heightmap) {
+    v2i column = v2i {chunk_x, chunk_z};
+    HeightmapCacheEntry* entry = hashmapGet(&cache->hashmap, column);
+
+    if (entry) {
+        heightmapCacheUnlink(cache, entry);
+    } else {
+        // NOTE: Take a never used entry, or evict the least recently used one.
+        if (cache->entries_count < HEIGHTMAP_CACHE_SIZE) {
+            entry = &cache->entries[cache->entries_count++];
+        } else {
+            entry = cache->least_recent;
+            heightmapCacheUnlink(cache, entry);
+            hashmapRemove(&cache->hashmap, entry->column);
+        }
+
+        entry->column = column;
+        hashmapInsert(&cache->hashmap, column, entry);
+    }
+
+    entry->heightmap = *heightmap;
+    heightmapCacheTouch(cache, entry);
+    return &entry->heightmap;
+}
+
+ChunkHeightmap* getCachedChunkHeightmap(HeightmapCache* cache, TerrainDescription* description, i32 chunk_x, i32 chunk_z) {
+    ChunkHeightmap* cached_heightmap = findCachedChunkHeightmap(cache, chunk_x, chunk_z);
+    if (cached_heightmap) return cached_heightmap;
+
+    ChunkHeightmap heightmap;
+    generateTerrainHeightmap(description, chunk_x, chunk_z, &heightmap);
+    return insertCachedChunkHeightmap(cache, chunk_x, chunk_z, &heightmap);
+}
+
+void clearHeightmapCache(HeightmapCache* cache) {
+    for (usize entry_idx = 0; entry_idx < cache->entries_count; entry_idx++) {
+        hashmapRemove(&cache->hashmap, cache->entries[entry_idx].column);
+    }
+    cache->entries_count = 0;
+    cache->most_recent = nullptr;
+    cache->least_recent = nullptr;
+}
+
+void fillChunkBlocksFromHeightmap(ChunkHeightmap* heightmap, i32 chunk_y, ChunkBlocks* out_blocks) {
+    for (i32 z = 0; z < CHUNK_W; z++) {
+        for (i32 y = 0; y < CHUNK_W; y++) {
+            i64 block_y = (i64)chunk_y * CHUNK_W + y;
+
+            __m128 depths[4];
+            for (u32 i = 0; i < 4; i++) {
+                __m128 heights = _mm_loadu_ps(&heightmap->heights[z * CHUNK_W + i * 4]);
+                depths[i] = _mm_sub_ps(heights, _mm_set1_ps((f32)block_y));
+            }
+
+            assignBlockTypesRow(depths, block_y, &out_blocks->data[y * CHUNK_W + z * CHUNK_W * CHUNK_W]);
+        }
+    }
+}
+
+// NOTE: Simplex noise is scaled to be within [-1, 1], but that's only
+// approximate (2D gets within 1e-6 of it), so the bounds get an extra block
+// on each side to stay conservative.
+constexpr f32 TERRAIN_BOUNDS_MARGIN = 1.f;
+
+static f32 terrainAmplitudesSum(TerrainDescription* description) {
+    f32 sum = 0;
+    f32 amplitude = description->amplitude;
+    for (u32 octave = 0; octave < description->octaves_count; octave++) {
+        sum += amplitude;
+        amplitude *= description->gain;
+    }
+    return sum;
+}
+
+ChunkFill classifyChunkFromTerrainBounds(TerrainDescription* description, i32 chunk_y) {
+    f32 amplitudes_sum = terrainAmplitudesSum(description);
+    f32 chunk_min_y = (f32)((i64)chunk_y * CHUNK_W);
+    f32 chunk_max_y = (f32)((i64)chunk_y * CHUNK_W + CHUNK_W - 1);
+
+    // NOTE: The heights are in [0, amplitudes_sum]. For the density, the
+    // noise is in [-amplitudes_sum, amplitudes_sum] (the interpolation
+    // can't get out of the range of the samples), so the surface is within
+    // that distance of base_height.
+    f32 min_surface_y = 0;
+    f32 max_surface_y = 0;
+    switch (description->kind) {
+        case TERRAIN_HEIGHTMAP: {
+            min_surface_y = 0;
+            max_surface_y = amplitudes_sum;
+        } break;
+        case TERRAIN_DENSITY_3D: {
+            min_surface_y = description->base_height - amplitudes_sum;
+            max_surface_y = description->base_height + amplitudes_sum;
+        } break;
+    }
+
+    if (chunk_min_y > max_surface_y + TERRAIN_BOUNDS_MARGIN) return CHUNK_FILL_AIR;
+    if (chunk_max_y < min_surface_y - TERRAIN_STONE_DEPTH - TERRAIN_BOUNDS_MARGIN) return CHUNK_FILL_SOLID;
+    return CHUNK_FILL_MIXED;
+}
+
+// NOTE: Exact, since the heights are known: the blocks at or below the
+// height of their column are solid, and stone from TERRAIN_STONE_DEPTH below.
+ChunkFill classifyChunkFromHeightmap(ChunkHeightmap* heightmap, i32 chunk_y) {
+    f32 chunk_min_y = (f32)((i64)chunk_y * CHUNK_W);
+    f32 chunk_max_y = (f32)((i64)chunk_y * CHUNK_W + CHUNK_W - 1);
+
+    if (chunk_min_y > heightmap->max_height) return CHUNK_FILL_AIR;
+    if (chunk_max_y + TERRAIN_STONE_DEPTH <= heightmap->min_height) return CHUNK_FILL_SOLID;
+    return CHUNK_FILL_MIXED;
+}
+
+static void generateChunkBlocksWithoutBounds(TerrainDescription* description, v3i chunk_position, ChunkBlocks* out_blocks) {
+    switch (description->kind) {
+        case TERRAIN_HEIGHTMAP: {
+            ChunkHeightmap heightmap;
+            generateTerrainHeightmap(description, chunk_position.x(), chunk_position.z(), &heightmap);
+            fillChunkBlocksFromHeightmap(&heightmap, chunk_position.y(), out_blocks);
+        } break;
+        case TERRAIN_DENSITY_3D: {
+            ChunkDensityLattice lattice;
+            generateTerrainDensityLattice(description, chunk_position, &lattice);
+            fillChunkBlocksFromDensityLattice(description, &lattice, chunk_position.y(), out_blocks);
+        } break;
+    }
+}
+
+void generateChunkBlocks(TerrainDescription* description, v3i chunk_position, ChunkBlocks* out_blocks) {
+    ChunkFill fill = classifyChunkFromTerrainBounds(description, chunk_position.y());
+    if (fill == CHUNK_FILL_MIXED) {
+        generateChunkBlocksWithoutBounds(description, chunk_position, out_blocks);
+        return;
+    }
+
+    for (usize block_idx = 0; block_idx < CHUNK_W * CHUNK_W * CHUNK_W; block_idx++) {
+        out_blocks->data[block_idx] = fill == CHUNK_FILL_SOLID ? BLOCK_STONE : BLOCK_AIR;
+    }
+
+    // NOTE: Check that the bounds really are conservative.
+    #if ENGINE_SLOW
+    ChunkBlocks generated_blocks;
+    generateChunkBlocksWithoutBounds(description, chunk_position, &generated_blocks);
+    for (usize block_idx = 0; block_idx < CHUNK_W * CHUNK_W * CHUNK_W; block_idx++) {
+        ASSERT(generated_blocks.data[block_idx] == out_blocks->data[block_idx]);
+    }
+    #endif
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "common.h"
+#include "maths.h"
+#include "containers.h"
+#include "chunk_types.h"
+
+// NOTE: The terrain generator. Everything here only depends on the terrain
+// description and the chunk positions, not on the game state, so it can also
+// be run on its own to profile and tune the generation.
+
+enum TerrainKind {
+    // NOTE: Fractal noise evaluated in 2D gives the height of every column.
+    TERRAIN_HEIGHTMAP,
+    // NOTE: Fractal noise evaluated in 3D gives a density for every block,
+    // and the blocks with a positive density are solid. Unlike a heightmap,
+    // this can make overhangs, arches and caves.
+    TERRAIN_DENSITY_3D,
+};
+
+// NOTE: The fancy name is "fractal brownian motion", but it's just summing
+// noise layers (octaves) with reducing intensity and increasing frequency.
+// Every octave multiplies the frequency by the lacunarity and the amplitude
+// by the gain.
+struct TerrainDescription {
+    TerrainKind kind;
+    u64 seed;
+    u32 octaves_count;
+    // NOTE: Frequency of the first octave, in noise units per block.
+    f32 scale;
+    // NOTE: Amplitude of the first octave, in blocks.
+    f32 amplitude;
+    f32 lacunarity;
+    f32 gain;
+
+    // NOTE: Only used by TERRAIN_DENSITY_3D. The density of a block is the
+    // noise plus (base_height - y), so the surface is around base_height, and
+    // the noise moves it by up to the amplitude (in every direction).
+    f32 base_height;
+    // NOTE: Only used by TERRAIN_DENSITY_3D. The noise is only evaluated every
+    // lattice_step blocks along each axis, and trilinearly interpolated in
+    // between. Bigger steps are faster but smooth out the high octaves. It has
+    // to be a power of two, at most CHUNK_W.
+    u32 lattice_step;
+};
+
+// NOTE: The presets get a version of the generator specialized at compile
+// time, with the octave loop unrolled. Other descriptions go through the same
+// code with runtime values, and give the exact same results.
+inline constexpr TerrainDescription TERRAIN_PRESET_HILLS = {
+    .kind = TERRAIN_HEIGHTMAP,
+    .seed = 0xC0FFEE,
+    .octaves_count = 5,
+    .scale = 0.01f,
+    .amplitude = 32.f,
+    .lacunarity = 2.f,
+    .gain = 1.f / 3.f,
+};
+
+inline constexpr TerrainDescription TERRAIN_PRESET_MOUNTAINS = {
+    .kind = TERRAIN_HEIGHTMAP,
+    .seed = 0xC0FFEE,
+    .octaves_count = 7,
+    .scale = 0.004f,
+    .amplitude = 96.f,
+    .lacunarity = 2.f,
+    .gain = 0.45f,
+};
+
+// NOTE: The same cliffs at three quality / speed tradeoffs: 9x9x9, 5x5x5
+// and 3x3x3 noise samples per chunk (for every octave) instead of 16x16x16.
+inline constexpr TerrainDescription TERRAIN_PRESET_CLIFFS = {
+    .kind = TERRAIN_DENSITY_3D,
+    .seed = 0xC0FFEE,
+    .octaves_count = 4,
+    .scale = 0.012f,
+    .amplitude = 40.f,
+    .lacunarity = 2.f,
+    .gain = 0.5f,
+    .base_height = 16.f,
+    .lattice_step = 4,
+};
+
+inline constexpr TerrainDescription TERRAIN_PRESET_CLIFFS_QUALITY = {
+    .kind = TERRAIN_DENSITY_3D,
+    .seed = 0xC0FFEE,
+    .octaves_count = 4,
+    .scale = 0.012f,
+    .amplitude = 40.f,
+    .lacunarity = 2.f,
+    .gain = 0.5f,
+    .base_height = 16.f,
+    .lattice_step = 2,
+};
+
+inline constexpr TerrainDescription TERRAIN_PRESET_CLIFFS_FAST = {
+    .kind = TERRAIN_DENSITY_3D,
+    .seed = 0xC0FFEE,
+    .octaves_count = 4,
+    .scale = 0.012f,
+    .amplitude = 40.f,
+    .lacunarity = 2.f,
+    .gain = 0.5f,
+    .base_height = 16.f,
+    .lattice_step = 8,
+};
+
+// NOTE: In the order the game cycles through them.
+inline constexpr const TerrainDescription* TERRAIN_PRESETS[] = {
+    &TERRAIN_PRESET_HILLS,
+    &TERRAIN_PRESET_MOUNTAINS,
+    &TERRAIN_PRESET_CLIFFS_QUALITY,
+    &TERRAIN_PRESET_CLIFFS,
+    &TERRAIN_PRESET_CLIFFS_FAST,
+};
+constexpr u32 TERRAIN_PRESETS_COUNT = ARRAY_COUNT(TERRAIN_PRESETS);
+
+// NOTE: The type of a solid block only depends on its depth below the
+// surface: the top layer is grass (or snow above the snow line), then there
+// are a few blocks of dirt, and stone under that. For heightmaps, the depth
+// is the height of the column minus the y of the block. For the density, it's
+// the density itself: the vertical gradient is one per block, so it's close
+// to the depth where the terrain isn't too steep, and cliffs get more stone.
+constexpr f32 TERRAIN_DIRT_DEPTH = 1.f;
+constexpr f32 TERRAIN_STONE_DEPTH = 4.f;
+constexpr f32 TERRAIN_SNOW_HEIGHT = 40.f;
+
+// NOTE: The terrain height only depends on (x, z), so it is computed once
+// per column of blocks, and the blocks are then filled by comparing their y
+// against it. All the chunks stacked in the same column share the heightmap.
+struct ChunkHeightmap {
+    f32 heights[CHUNK_W * CHUNK_W];
+    f32 min_height;
+    f32 max_height;
+};
+
+void generateTerrainHeightmap(TerrainDescription* description, i32 chunk_x, i32 chunk_z, ChunkHeightmap* out_heightmap);
+void fillChunkBlocksFromHeightmap(ChunkHeightmap* heightmap, i32 chunk_y, ChunkBlocks* out_blocks);
+
+// NOTE: The density noise sampled on the lattice of one chunk. The samples
+// are at the block positions multiple of the lattice step, including the ones
+// of the next chunk on every axis, so that the interpolation in the last
+// blocks has its upper samples.
+constexpr usize DENSITY_LATTICE_MAX_W = CHUNK_W + 1;
+
+struct ChunkDensityLattice {
+    f32 values[DENSITY_LATTICE_MAX_W * DENSITY_LATTICE_MAX_W * DENSITY_LATTICE_MAX_W];
+    u32 points_w;
+};
+
+void generateTerrainDensityLattice(TerrainDescription* description, v3i chunk_position, ChunkDensityLattice* out_lattice);
+void fillChunkBlocksFromDensityLattice(TerrainDescription* description, ChunkDensityLattice* lattice, i32 chunk_y, ChunkBlocks* out_blocks);
+
+// NOTE: Most chunks of the load sphere are far above or below the surface.
+// Their fill can be known from conservative bounds on the terrain, without
+// looking at a single block. Solid means only stone, so the chunks just below
+// the surface, that have some dirt, are not solid. The bounds are cheap: the analytic range of the
+// fractal noise (the sum of the octave amplitudes) only depends on the chunk
+// y, and the heightmap range is computed once per column.
+enum ChunkFill {
+    // NOTE: The bounds can't tell, the blocks have to be generated.
+    CHUNK_FILL_MIXED,
+    CHUNK_FILL_AIR,
+    CHUNK_FILL_SOLID,
+};
+
+ChunkFill classifyChunkFromTerrainBounds(TerrainDescription* description, i32 chunk_y);
+ChunkFill classifyChunkFromHeightmap(ChunkHeightmap* heightmap, i32 chunk_y);
+
+// NOTE: Generates the blocks of one chunk from scratch, for any terrain kind.
+// Chunks the bounds can classify are filled directly.
+void generateChunkBlocks(TerrainDescription* description, v3i chunk_position, ChunkBlocks* out_blocks);
+
+// NOTE: The heightmaps of the last columns chunks were generated in, kept
+// across frames so that the chunks loaded later in the same column (when the
+// player moves vertically) don't recompute the noise. There is room for every
+// column of the load cube, so the cache only evicts when the player moves
+// horizontally, and then the least recently used column is likely the one
+// furthest behind. It has to be cleared if the terrain description changes.
+constexpr usize HEIGHTMAP_CACHE_SIZE = (LOAD_RADIUS * 2 + 1) * (LOAD_RADIUS * 2 + 1);
+
+struct HeightmapCacheEntry {
+    v2i column;
+    ChunkHeightmap heightmap;
+
+    // NOTE: LRU list, from the most to the least recently used.
+    HeightmapCacheEntry* prev;
+    HeightmapCacheEntry* next;
+};
+
+constexpr usize columnPositionHash(v2i column) {
+    usize hash = 0;
+    hash ^= (usize)(column.x() * 73856093);
+    hash ^= (usize)(column.y() * 83492791);
+    return hash;
+}
+
+struct HeightmapCache {
+    HeightmapCacheEntry entries[HEIGHTMAP_CACHE_SIZE];
+    usize entries_count;
+    Hashmap<HeightmapCacheEntry*, v2i, nextPowerOfTwo(HEIGHTMAP_CACHE_SIZE * 2), columnPositionHash> hashmap;
+
+    HeightmapCacheEntry* most_recent;
+    HeightmapCacheEntry* least_recent;
+
+    u64 hits_count;
+    u64 misses_count;
+};
+
+// NOTE: Returns the heightmap of the column, generating it on a miss.
+ChunkHeightmap* getCachedChunkHeightmap(HeightmapCache* cache, TerrainDescription* description, i32 chunk_x, i32 chunk_z);
+
+// NOTE: For heightmaps generated somewhere else (like on a worker thread):
+// find returns nullptr on a miss, and insert copies the heightmap in, or
+// overwrites it if the column is already there.
+ChunkHeightmap* findCachedChunkHeightmap(HeightmapCache* cache, i32 chunk_x, i32 chunk_z);
+ChunkHeightmap* insertCachedChunkHeightmap(HeightmapCache* cache, i32 chunk_x, i32 chunk_z, ChunkHeightmap* heightmap);
+void clearHeightmapCache(HeightmapCache* cache);
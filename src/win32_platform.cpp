@@ -214,6 +214,105 @@ void pollGameInput(HWND window, IGameInput* game_input, WindowsInputState* previ
     }
 }
 
+// NOTE: A single producer (the main thread), multiple consumers (the workers
+// and the main thread in win32CompleteAllWork) ring buffer. The semaphore
+// counts the entries to wake up workers without spinning.
+struct PlatformWorkQueueEntry {
+    PlatformWorkQueueCallback* callback;
+    void* data;
+};
+
+struct PlatformWorkQueue {
+    volatile u32 completion_goal;
+    volatile u32 completion_count;
+
+    volatile u32 next_entry_to_write;
+    volatile u32 next_entry_to_read;
+    HANDLE semaphore;
+
+    PlatformWorkQueueEntry entries[PLATFORM_WORK_QUEUE_SIZE];
+};
+
+global PlatformWorkQueue global_work_queue;
+
+void win32AddWorkEntry(PlatformWorkQueue* queue, PlatformWorkQueueCallback* callback, void* data) {
+    u32 next_entry_to_write = (queue->next_entry_to_write + 1) % PLATFORM_WORK_QUEUE_SIZE;
+    ASSERT(next_entry_to_write != queue->next_entry_to_read);
+
+    PlatformWorkQueueEntry* entry = &queue->entries[queue->next_entry_to_write];
+    entry->callback = callback;
+    entry->data = data;
+    queue->completion_goal++;
+
+    // NOTE: The entry has to be written before the workers can see it.
+    MemoryBarrier();
+    queue->next_entry_to_write = next_entry_to_write;
+    ReleaseSemaphore(queue->semaphore, 1, nullptr);
+}
+
+// NOTE: Returns true if there was nothing to do.
+b32 win32DoNextWorkEntry(PlatformWorkQueue* queue) {
+    u32 original_next_entry_to_read = queue->next_entry_to_read;
+    if (original_next_entry_to_read == queue->next_entry_to_write) return true;
+
+    // NOTE: Another thread may take the entry first, in which case the
+    // exchange fails and we just try again on the next one.
+    u32 next_entry_to_read = (original_next_entry_to_read + 1) % PLATFORM_WORK_QUEUE_SIZE;
+    u32 index = InterlockedCompareExchange((LONG volatile*)&queue->next_entry_to_read, next_entry_to_read, original_next_entry_to_read);
+    if (index == original_next_entry_to_read) {
+        PlatformWorkQueueEntry entry = queue->entries[index];
+        entry.callback(entry.data);
+        InterlockedIncrement((LONG volatile*)&queue->completion_count);
+    }
+
+    return false;
+}
+
+void win32CompleteAllWork(PlatformWorkQueue* queue) {
+    while (queue->completion_goal != queue->completion_count) {
+        win32DoNextWorkEntry(queue);
+    }
+
+    queue->completion_goal = 0;
+    queue->completion_count = 0;
+}
+
+DWORD WINAPI workerThreadProc(LPVOID parameter) {
+    PlatformWorkQueue* queue = (PlatformWorkQueue*)parameter;
+    for (;;) {
+        if (win32DoNextWorkEntry(queue)) {
+            WaitForSingleObjectEx(queue->semaphore, INFINITE, FALSE);
+        }
+    }
+}
+
+// NOTE: "-threads N" on the command line, otherwise one worker per logical
+// core minus the one the main thread runs on.
+u32 getWorkerThreadsCount(LPSTR command_line) {
+    constexpr u32 MAX_WORKER_THREADS = 64;
+
+    const char* option = "-threads ";
+    for (char* c = command_line; *c; c++) {
+        u32 matched = 0;
+        while (option[matched] && c[matched] == option[matched]) matched++;
+        if (option[matched] != 0) continue;
+
+        u32 count = 0;
+        for (char* digit = c + matched; *digit >= '0' && *digit <= '9'; digit++) {
+            count = count * 10 + (*digit - '0');
+        }
+        if (count < 1) count = 1;
+        if (count > MAX_WORKER_THREADS) count = MAX_WORKER_THREADS;
+        return count;
+    }
+
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    u32 count = system_info.dwNumberOfProcessors > 1 ? system_info.dwNumberOfProcessors - 1 : 1;
+    if (count > MAX_WORKER_THREADS) count = MAX_WORKER_THREADS;
+    return count;
+}
+
 typedef decltype(&gameUpdate) GameUpdatePtr;
 
 struct GameCode {
@@ -417,6 +516,19 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     game_memory.permanent_storage = VirtualAlloc((void*)TERABYTES(2), game_memory.permanent_storage_size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
     ASSERT(game_memory.permanent_storage != NULL);
 
+    u32 worker_threads_count = getWorkerThreadsCount(lpCmdLine);
+    global_work_queue.semaphore = CreateSemaphoreExA(nullptr, 0, PLATFORM_WORK_QUEUE_SIZE, nullptr, 0, SEMAPHORE_ALL_ACCESS);
+    for (u32 thread_idx = 0; thread_idx < worker_threads_count; thread_idx++) {
+        HANDLE thread = CreateThread(nullptr, 0, workerThreadProc, &global_work_queue, 0, nullptr);
+        ASSERT(thread != NULL);
+        CloseHandle(thread);
+    }
+
+    game_memory.work_queue = &global_work_queue;
+    game_memory.worker_threads_count = worker_threads_count;
+    game_memory.platformAddWorkEntry = win32AddWorkEntry;
+    game_memory.platformCompleteAllWork = win32CompleteAllWork;
+
     GameCode game_code = {};
 
     // NOTE: game input double-buffering
@@ -456,6 +568,8 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         const char* dll_name = "game.dll";
         FILETIME dll_time = getFileLastWriteTime(dll_name);
         if (CompareFileTime(&dll_time, &game_code.write_time) != 0) {
+            // NOTE: The queued work calls into the old game code.
+            win32CompleteAllWork(&global_work_queue);
             unloadGameCode(&game_code);
             loadGameCode(&game_code, dll_name);
         }
@@ -1,142 +1,632 @@
+#include <emmintrin.h>
+
 #include "world.h"
 
-// TODO: Many duplicate vertices. Is it easy/possible to use indices here ?
-// TODO: Currently the chunk doesn't look into neighboring chunks. This means there are generated
-// triangles between solid blocks on two different chunks.
-void generateNaiveChunkMesh(WorldHashmap* world_hashmap, Chunk* chunk, ChunkVertex* out_vertices, usize* out_generated_vertex_count) {
-    usize emitted = 0;
-    for(usize i = 0; i < CHUNK_W * CHUNK_W * CHUNK_W; i++){
+// NOTE: Index of a block inside a padded chunk, from chunk-local coordinates
+// that can go one block outside of the chunk.
+inline usize paddedBlockIndex(i32 x, i32 y, i32 z) {
+    return (usize)((x + 1) + (y + 1) * PADDED_CHUNK_W + (z + 1) * PADDED_CHUNK_W * PADDED_CHUNK_W);
+}
 
-        usize x = (i % CHUNK_W);
-        usize y = (i / CHUNK_W) % (CHUNK_W);
-        usize z = (i / (CHUNK_W * CHUNK_W));
+void addChunkToList(ChunkList* list, ChunkListKind kind, Chunk* chunk) {
+    if (chunk->list_positions[kind]) return;
+    ASSERT(list->count < CHUNK_POOL_SIZE);
 
-        if (!chunk->data[i]) continue;
+    list->chunks[list->count] = chunk;
+    list->count++;
+    chunk->list_positions[kind] = (u16)list->count;
+}
 
-        b32 create_face_pos_x = false;
-        b32 create_face_neg_x = false;
-        b32 create_face_pos_y = false;
-        b32 create_face_neg_y = false;
-        b32 create_face_pos_z = false;
-        b32 create_face_neg_z = false;
+void removeChunkFromList(ChunkList* list, ChunkListKind kind, Chunk* chunk) {
+    if (!chunk->list_positions[kind]) return;
 
-        if (x < (CHUNK_W - 1)) {
-            create_face_pos_x = !chunk->data[i + 1];
-        } else {
-            Chunk* neighbor = hashmapGet(world_hashmap, chunk->chunk_position + v3i {1, 0, 0});
-            if (neighbor) {
-                create_face_pos_x = !neighbor->data[y * CHUNK_W + z * CHUNK_W * CHUNK_W];
+    usize position = chunk->list_positions[kind] - 1;
+    Chunk* last_chunk = list->chunks[list->count - 1];
+    list->chunks[position] = last_chunk;
+    last_chunk->list_positions[kind] = (u16)(position + 1);
+
+    list->count--;
+    chunk->list_positions[kind] = 0;
+}
+
+void buildChunkSphereOffsets(i32 radius, ChunkSphereOffsets* out_offsets) {
+    ASSERT(radius <= UNLOAD_RADIUS);
+
+    *out_offsets = {};
+    out_offsets->radius = radius;
+    v3i center = {};
+
+    for (i32 x = -radius; x <= radius; x++) {
+        for (i32 z = -radius; z <= radius; z++) {
+            for (i32 y = -radius; y <= radius; y++) {
+                v3i offset = v3i {x, y, z};
+                if (!isInChunkSphere(center, offset, radius)) continue;
+
+                out_offsets->sphere[out_offsets->sphere_count++] = offset;
+
+                for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+                    v3i next = offset;
+                    next.data[direction / 2] += (direction % 2) == 0 ? 1 : -1;
+                    if (isInChunkSphere(center, next, radius)) continue;
+
+                    ASSERT(out_offsets->shells_count[direction] < CHUNK_SHELL_MAX_OFFSETS);
+                    out_offsets->shells[direction][out_offsets->shells_count[direction]++] = offset;
+                }
             }
         }
+    }
+}
 
-        if (x > 0) {
-            create_face_neg_x = !chunk->data[i - 1];
-        } else {
-            Chunk* neighbor = hashmapGet(world_hashmap, chunk->chunk_position - v3i {1, 0, 0});
-            if (neighbor) {
-                create_face_neg_x = !neighbor->data[(CHUNK_W - 1) + y * CHUNK_W + z * CHUNK_W * CHUNK_W];
+void gatherPaddedChunk(WorldHashmap* world_hashmap, Chunk* chunk, PaddedChunk* out_padded) {
+    Chunk* neighbors[FACE_DIRECTION_COUNT];
+    neighbors[FACE_POS_X] = hashmapGet(world_hashmap, chunk->chunk_position + v3i {1, 0, 0});
+    neighbors[FACE_NEG_X] = hashmapGet(world_hashmap, chunk->chunk_position - v3i {1, 0, 0});
+    neighbors[FACE_POS_Y] = hashmapGet(world_hashmap, chunk->chunk_position + v3i {0, 1, 0});
+    neighbors[FACE_NEG_Y] = hashmapGet(world_hashmap, chunk->chunk_position - v3i {0, 1, 0});
+    neighbors[FACE_POS_Z] = hashmapGet(world_hashmap, chunk->chunk_position + v3i {0, 0, 1});
+    neighbors[FACE_NEG_Z] = hashmapGet(world_hashmap, chunk->chunk_position - v3i {0, 0, 1});
+
+    // NOTE: The edges and corners of the border are not read by anyone, but
+    // we still don't want garbage in there.
+    *out_padded = {};
+
+    // NOTE: The chunk itself, one row along X at a time.
+    for (i32 z = 0; z < CHUNK_W; z++) {
+        for (i32 y = 0; y < CHUNK_W; y++) {
+            u8* dst = &out_padded->data[paddedBlockIndex(0, y, z)];
+            if (chunk->blocks) {
+                u8* src = &chunk->blocks->data[y * CHUNK_W + z * CHUNK_W * CHUNK_W];
+                for (i32 x = 0; x < CHUNK_W; x++) {
+                    dst[x] = src[x];
+                }
+            } else {
+                for (i32 x = 0; x < CHUNK_W; x++) {
+                    dst[x] = chunk->uniform_block;
+                }
             }
         }
+    }
 
-        if (y < (CHUNK_W - 1)) {
-            create_face_pos_y = !chunk->data[i + CHUNK_W];
-        } else {
-            Chunk* neighbor = hashmapGet(world_hashmap, chunk->chunk_position + v3i {0, 1, 0});
-            if (neighbor) {
-                create_face_pos_y = !neighbor->data[x + z * CHUNK_W * CHUNK_W];
+    // NOTE: The boundary slices of the six neighbors. Blocks in neighbors that
+    // are not loaded, or still generating, are considered solid, so that we
+    // don't create faces at the boundary with them : they will be remeshed once
+    // the neighbor gets its blocks.
+    for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+        Chunk* neighbor = neighbors[direction];
+        if (neighbor && neighbor->is_generating) neighbor = nullptr;
+        u32 axis = direction / 2;
+        u32 axis_u = (axis + 1) % 3;
+        u32 axis_v = (axis + 2) % 3;
+        b32 is_positive = (direction % 2) == 0;
+
+        for (i32 v = 0; v < CHUNK_W; v++) {
+            for (i32 u = 0; u < CHUNK_W; u++) {
+                i32 block[3];
+                block[axis_u] = u;
+                block[axis_v] = v;
+
+                // NOTE: The slice of the neighbor touching this chunk.
+                block[axis] = is_positive ? 0 : CHUNK_W - 1;
+                u8 value = neighbor ? getChunkBlock(neighbor, block[0] + block[1] * CHUNK_W + block[2] * CHUNK_W * CHUNK_W) : BLOCK_STONE;
+
+                // NOTE: And where it goes in the padded border.
+                block[axis] = is_positive ? CHUNK_W : -1;
+                out_padded->data[paddedBlockIndex(block[0], block[1], block[2])] = value;
             }
         }
+    }
+}
 
-        if (y > 0) {
-            create_face_neg_y = !chunk->data[i - CHUNK_W];
-        } else {
-            Chunk* neighbor = hashmapGet(world_hashmap, chunk->chunk_position - v3i {0, 1, 0});
-            if (neighbor) {
-                create_face_neg_y = !neighbor->data[x + (CHUNK_W - 1) * CHUNK_W + z * CHUNK_W * CHUNK_W];
+void downsamplePaddedChunk(PaddedChunk* padded, u32 lod) {
+    if (lod == 0) return;
+    i32 cell_w = 1 << lod;
+
+    for (i32 cell_z = 0; cell_z < CHUNK_W; cell_z += cell_w) {
+        for (i32 cell_y = 0; cell_y < CHUNK_W; cell_y += cell_w) {
+            for (i32 cell_x = 0; cell_x < CHUNK_W; cell_x += cell_w) {
+                // NOTE: The cell takes the first solid block it finds.
+                u8 value = 0;
+                for (i32 z = cell_z; z < cell_z + cell_w && !value; z++) {
+                    for (i32 y = cell_y; y < cell_y + cell_w && !value; y++) {
+                        for (i32 x = cell_x; x < cell_x + cell_w && !value; x++) {
+                            value = padded->data[paddedBlockIndex(x, y, z)];
+                        }
+                    }
+                }
+
+                for (i32 z = cell_z; z < cell_z + cell_w; z++) {
+                    for (i32 y = cell_y; y < cell_y + cell_w; y++) {
+                        for (i32 x = cell_x; x < cell_x + cell_w; x++) {
+                            padded->data[paddedBlockIndex(x, y, z)] = value;
+                        }
+                    }
+                }
             }
         }
+    }
+}
 
-        if (z < (CHUNK_W - 1)) {
-            create_face_pos_z = !chunk->data[i + CHUNK_W * CHUNK_W];
-        } else {
-            Chunk* neighbor = hashmapGet(world_hashmap, chunk->chunk_position + v3i {0, 0, 1});
-            if (neighbor) {
-                create_face_pos_z = !neighbor->data[x + y * CHUNK_W];
-            }
+b32 isChunkMeshTriviallyEmpty(WorldHashmap* world_hashmap, Chunk* chunk) {
+    if (chunk->blocks) return false;
+    if (!chunk->uniform_block) return true;
+
+    // NOTE: The chunk is all solid, so it only has faces where one of the
+    // neighbors touches it with air. Unloaded and generating neighbors count
+    // as solid.
+    for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+        u32 axis = direction / 2;
+        b32 is_positive = (direction % 2) == 0;
+
+        v3i neighbor_position = chunk->chunk_position;
+        neighbor_position.data[axis] += is_positive ? 1 : -1;
+
+        Chunk* neighbor = hashmapGet(world_hashmap, neighbor_position);
+        if (!neighbor || neighbor->is_generating) continue;
+
+        if (!neighbor->blocks) {
+            if (!neighbor->uniform_block) return false;
+            continue;
         }
 
-        if (z > 0) {
-            create_face_neg_z = !chunk->data[i - CHUNK_W * CHUNK_W];
-        } else {
-            Chunk* neighbor = hashmapGet(world_hashmap, chunk->chunk_position - v3i {0, 0, 1});
-            if (neighbor) {
-                create_face_neg_z = !neighbor->data[x + y * CHUNK_W + (CHUNK_W - 1) * CHUNK_W * CHUNK_W];
+        // NOTE: Check the slice of the neighbor touching this chunk.
+        u32 axis_u = (axis + 1) % 3;
+        u32 axis_v = (axis + 2) % 3;
+        for (i32 v = 0; v < CHUNK_W; v++) {
+            for (i32 u = 0; u < CHUNK_W; u++) {
+                i32 block[3];
+                block[axis] = is_positive ? 0 : CHUNK_W - 1;
+                block[axis_u] = u;
+                block[axis_v] = v;
+                if (!neighbor->blocks->data[block[0] + block[1] * CHUNK_W + block[2] * CHUNK_W * CHUNK_W]) return false;
             }
         }
+    }
 
-        v3 position = {(f32)x, (f32)y, (f32)z};
+    return true;
+}
 
-        if (create_face_pos_x) {
-            out_vertices[emitted++] = {position + v3 {1, 0, 0}, v3 {1, 0, 0}};
-            out_vertices[emitted++] = {position + v3 {1, 1, 0}, v3 {1, 0, 0}};
-            out_vertices[emitted++] = {position + v3 {1, 0, 1}, v3 {1, 0, 0}};
+void generateNaiveChunkMesh(PaddedChunk* padded, u32 section, ChunkVertex* out_vertices, usize* out_generated_vertex_count, ChunkMeshRanges* out_ranges) {
+    // NOTE: Thanks to the border, the neighbor blocks are always at the
+    // same offsets in the padded buffer, even at the chunk boundaries.
+    constexpr i32 neighbor_offsets[FACE_DIRECTION_COUNT] = {
+        1, -1,
+        PADDED_CHUNK_W, -PADDED_CHUNK_W,
+        PADDED_CHUNK_W * PADDED_CHUNK_W, -PADDED_CHUNK_W * PADDED_CHUNK_W,
+    };
 
-            out_vertices[emitted++] = {position + v3 {1, 1, 0}, v3 {1, 0, 0}};
-            out_vertices[emitted++] = {position + v3 {1, 1, 1}, v3 {1, 0, 0}};
-            out_vertices[emitted++] = {position + v3 {1, 0, 1}, v3 {1, 0, 0}};
+    // NOTE: The 4 corners of each face, relative to the block position.
+    constexpr i32 face_corners[FACE_DIRECTION_COUNT][4][3] = {
+        {{1, 0, 1}, {1, 0, 0}, {1, 1, 0}, {1, 1, 1}},
+        {{0, 1, 0}, {0, 0, 0}, {0, 0, 1}, {0, 1, 1}},
+        {{1, 1, 0}, {0, 1, 0}, {0, 1, 1}, {1, 1, 1}},
+        {{0, 0, 1}, {0, 0, 0}, {1, 0, 0}, {1, 0, 1}},
+        {{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}},
+        {{1, 1, 0}, {1, 0, 0}, {0, 0, 0}, {0, 1, 0}},
+    };
+
+    // NOTE: One pass over the chunk per direction, so that the faces
+    // end up grouped by direction.
+    usize emitted = 0;
+    for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+        out_ranges->first_vertex[direction] = emitted;
+
+        for (i32 z = 0; z < CHUNK_W; z++) {
+            for (i32 y = section * CHUNK_SECTION_H; y < (i32)(section + 1) * CHUNK_SECTION_H; y++) {
+                for (i32 x = 0; x < CHUNK_W; x++) {
+                    usize padded_idx = paddedBlockIndex(x, y, z);
+                    if (!padded->data[padded_idx]) continue;
+                    if (padded->data[padded_idx + neighbor_offsets[direction]]) continue;
+
+                    for (u32 corner = 0; corner < 4; corner++) {
+                        const i32* offset = face_corners[direction][corner];
+                        out_vertices[emitted++] = packChunkVertex(x + offset[0], y + offset[1], z + offset[2], direction, 0, padded->data[padded_idx]);
+                    }
+                }
+            }
         }
 
-        if (create_face_neg_x) {
-            out_vertices[emitted++] = {position + v3 {0, 0, 0}, v3 {-1, 0, 0}};
-            out_vertices[emitted++] = {position + v3 {0, 0, 1}, v3 {-1, 0, 0}};
-            out_vertices[emitted++] = {position + v3 {0, 1, 0}, v3 {-1, 0, 0}};
+        out_ranges->vertices_count[direction] = emitted - out_ranges->first_vertex[direction];
+    }
+
+    *out_generated_vertex_count = emitted;
+}
+
+// NOTE: Emits the four corners of a quad lying on the plane of a face direction.
+// The face direction gives us the axis the quad is perpendicular to, and the two
+// other axes (u, v) are taken in cyclic order (e.g. for X, u is Y and v is Z).
+// The corners are ordered so that the winding matches the one of the naive
+// mesher, otherwise backface culling would eat the wrong side.
+static void emitQuad(ChunkVertex* out_vertices, usize* emitted, u32 direction, i32 plane, i32 u0, i32 v0, i32 width, i32 height, u32 block_type) {
+    u32 axis = direction / 2;
+    u32 axis_u = (axis + 1) % 3;
+    u32 axis_v = (axis + 2) % 3;
+    b32 is_positive = (direction % 2) == 0;
+
+    // NOTE: Unit corner offsets in (u, v) space, counter-clockwise when
+    // looking at the quad from the side its normal points to.
+    constexpr i32 positive_corners[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    constexpr i32 negative_corners[4][2] = {{0, 0}, {0, 1}, {1, 1}, {1, 0}};
+    const i32 (*corners)[2] = is_positive ? positive_corners : negative_corners;
+
+    ChunkVertex vertices[4];
+    for (u32 corner = 0; corner < 4; corner++) {
+        u32 position[3];
+        position[axis] = plane;
+        position[axis_u] = u0 + corners[corner][0] * width;
+        position[axis_v] = v0 + corners[corner][1] * height;
+        vertices[corner] = packChunkVertex(position[0], position[1], position[2], direction, 0, block_type);
+    }
+
+    for (u32 corner = 0; corner < 4; corner++) {
+        out_vertices[(*emitted)++] = vertices[corner];
+    }
+}
+
+// NOTE: Transposes a 16x16 bit matrix in place, where bit j of rows[i] is the
+// element (i, j). This is the recursive block swap from Hacker's Delight (7-3),
+// adapted to 16 bits : swap the two off-diagonal 8x8 blocks, then the 4x4 blocks
+// inside all the 8x8 blocks, and so on down to single bits. Every step is a
+// template so the compiler can fully unroll it.
+template <u32 J, u16 M>
+inline void transposeBitMatrix16Step(u16 rows[16]) {
+    for (u32 k = 0; k < 16; k = (k + J + 1) & ~J) {
+        u16 t = ((rows[k] >> J) ^ rows[k + J]) & M;
+        rows[k + J] ^= t;
+        rows[k] ^= (u16)(t << J);
+    }
+}
+
+static void transposeBitMatrix16(u16 rows[16]) {
+    transposeBitMatrix16Step<8, 0x00FF>(rows);
+    transposeBitMatrix16Step<4, 0x0F0F>(rows);
+    transposeBitMatrix16Step<2, 0x3333>(rows);
+    transposeBitMatrix16Step<1, 0x5555>(rows);
+}
+
+// NOTE: Loads the solid blocks of a row along X as a bitmask. Blocks are stored
+// with X varying the fastest, so the row is 16 contiguous bytes : comparing them
+// against zero and keeping the top bit of every byte is two SSE2 instructions.
+inline u16 loadSolidRowX(PaddedChunk* padded, i32 y, i32 z) {
+    __m128i blocks = _mm_loadu_si128((__m128i*)&padded->data[paddedBlockIndex(0, y, z)]);
+    u32 air = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(blocks, _mm_setzero_si128()));
+    return (u16)~air;
+}
+
+void buildChunkFaceMasks(PaddedChunk* padded, ChunkFaceMasks* out_masks) {
+    // NOTE: The solid blocks of the chunk, in the same layout as the face masks
+    // for each axis : slices along the axis, rows along v, bits along u. Slices 0
+    // and 17 are the boundary slices of the neighbor chunks, so that faces at the
+    // boundary are found exactly like the others.
+    u16 solid[3][CHUNK_W + 2][CHUNK_W];
 
-            out_vertices[emitted++] = {position + v3 {0, 1, 0}, v3 {-1, 0, 0}};
-            out_vertices[emitted++] = {position + v3 {0, 0, 1}, v3 {-1, 0, 0}};
-            out_vertices[emitted++] = {position + v3 {0, 1, 1}, v3 {-1, 0, 0}};
+    // NOTE: Z slices (u = X, v = Y) are just the rows along X, neighbors included.
+    for (i32 z = -1; z <= CHUNK_W; z++) {
+        for (i32 y = 0; y < CHUNK_W; y++) {
+            solid[2][z + 1][y] = loadSolidRowX(padded, y, z);
         }
+    }
 
-        if (create_face_pos_y) {
-            out_vertices[emitted++] = {position + v3 {0, 1, 0}, v3 {0, 1, 0}};
-            out_vertices[emitted++] = {position + v3 {0, 1, 1}, v3 {0, 1, 0}};
-            out_vertices[emitted++] = {position + v3 {1, 1, 0}, v3 {0, 1, 0}};
+    // NOTE: X slices (u = Y, v = Z) and Y slices (u = Z, v = X) are obtained
+    // by transposing 16x16 blocks of the rows along X.
+    for (i32 z = 0; z < CHUNK_W; z++) {
+        u16 matrix[CHUNK_W];
+        for (i32 y = 0; y < CHUNK_W; y++) matrix[y] = solid[2][z + 1][y];
+        transposeBitMatrix16(matrix);
+        for (i32 x = 0; x < CHUNK_W; x++) solid[0][x + 1][z] = matrix[x];
+    }
+    for (i32 y = -1; y <= CHUNK_W; y++) {
+        u16 matrix[CHUNK_W];
+        for (i32 z = 0; z < CHUNK_W; z++) matrix[z] = loadSolidRowX(padded, y, z);
+        transposeBitMatrix16(matrix);
+        for (i32 x = 0; x < CHUNK_W; x++) solid[1][y + 1][x] = matrix[x];
+    }
 
-            out_vertices[emitted++] = {position + v3 {0, 1, 1}, v3 {0, 1, 0}};
-            out_vertices[emitted++] = {position + v3 {1, 1, 1}, v3 {0, 1, 0}};
-            out_vertices[emitted++] = {position + v3 {1, 1, 0}, v3 {0, 1, 0}};
+    // NOTE: The X boundary slices are the only ones that are not along rows,
+    // so read them block by block.
+    for (i32 z = 0; z < CHUNK_W; z++) {
+        u16 neg_row = 0;
+        u16 pos_row = 0;
+        for (i32 y = 0; y < CHUNK_W; y++) {
+            neg_row |= (u16)((padded->data[paddedBlockIndex(-1, y, z)] != 0) << y);
+            pos_row |= (u16)((padded->data[paddedBlockIndex(CHUNK_W, y, z)] != 0) << y);
         }
+        solid[0][0][z] = neg_row;
+        solid[0][CHUNK_W + 1][z] = pos_row;
+    }
 
-        if (create_face_neg_y) {
-            out_vertices[emitted++] = {position + v3 {0, 0, 0}, v3 {0, -1, 0}};
-            out_vertices[emitted++] = {position + v3 {1, 0, 0}, v3 {0, -1, 0}};
-            out_vertices[emitted++] = {position + v3 {0, 0, 1}, v3 {0, -1, 0}};
+    // NOTE: A face is visible when its block is solid and the next block in the
+    // face direction is not. With this layout, that is an AND-NOT between a row
+    // and the same row in the next (or previous) slice, for 16 faces at once.
+    for (u32 axis = 0; axis < 3; axis++) {
+        for (u32 slice = 0; slice < CHUNK_W; slice++) {
+            for (u32 v = 0; v < CHUNK_W; v++) {
+                u16 row = solid[axis][slice + 1][v];
+                out_masks->rows[axis * 2][slice][v] = row & ~solid[axis][slice + 2][v];
+                out_masks->rows[axis * 2 + 1][slice][v] = row & ~solid[axis][slice][v];
+            }
+        }
+    }
+}
 
-            out_vertices[emitted++] = {position + v3 {1, 0, 0}, v3 {0, -1, 0}};
-            out_vertices[emitted++] = {position + v3 {1, 0, 1}, v3 {0, -1, 0}};
-            out_vertices[emitted++] = {position + v3 {0, 0, 1}, v3 {0, -1, 0}};
+// NOTE: Transposes a 16x16 byte matrix, one row per register. Interleaving
+// the bytes of the two halves of the matrix 4 times puts every byte in its
+// transposed position.
+static void transposeByteMatrix16(__m128i rows[16]) {
+    for (u32 round = 0; round < 4; round++) {
+        __m128i interleaved[16];
+        for (u32 i = 0; i < 8; i++) {
+            interleaved[i * 2] = _mm_unpacklo_epi8(rows[i], rows[i + 8]);
+            interleaved[i * 2 + 1] = _mm_unpackhi_epi8(rows[i], rows[i + 8]);
+        }
+        for (u32 i = 0; i < 16; i++) {
+            rows[i] = interleaved[i];
+        }
+    }
+}
 
+void buildChunkFaceTypes(PaddedChunk* padded, ChunkFaceTypes* out_types) {
+    // NOTE: Same as the solid masks: the Z slices are the rows along X, and
+    // the X and Y slices are transposed 16x16 blocks of them.
+    for (i32 z = 0; z < CHUNK_W; z++) {
+        for (i32 y = 0; y < CHUNK_W; y++) {
+            __m128i row = _mm_loadu_si128((__m128i*)&padded->data[paddedBlockIndex(0, y, z)]);
+            _mm_storeu_si128((__m128i*)out_types->types[2][z][y], row);
         }
+    }
+
+    for (i32 z = 0; z < CHUNK_W; z++) {
+        __m128i matrix[CHUNK_W];
+        for (i32 y = 0; y < CHUNK_W; y++) matrix[y] = _mm_loadu_si128((__m128i*)out_types->types[2][z][y]);
+        transposeByteMatrix16(matrix);
+        for (i32 x = 0; x < CHUNK_W; x++) _mm_storeu_si128((__m128i*)out_types->types[0][x][z], matrix[x]);
+    }
+    for (i32 y = 0; y < CHUNK_W; y++) {
+        __m128i matrix[CHUNK_W];
+        for (i32 z = 0; z < CHUNK_W; z++) matrix[z] = _mm_loadu_si128((__m128i*)out_types->types[2][z][y]);
+        transposeByteMatrix16(matrix);
+        for (i32 x = 0; x < CHUNK_W; x++) _mm_storeu_si128((__m128i*)out_types->types[1][y][x], matrix[x]);
+    }
+}
+
+void restrictChunkFaceMasksToSection(ChunkFaceMasks* masks, u32 section, ChunkFaceMasks* out_masks) {
+    i32 section_begin = section * CHUNK_SECTION_H;
+    i32 section_end = section_begin + CHUNK_SECTION_H;
+    u16 section_bits = (u16)(((1u << CHUNK_SECTION_H) - 1) << section_begin);
 
-        if (create_face_pos_z) {
-            out_vertices[emitted++] = {position + v3 {0, 0, 1}, v3 {0, 0, 1}};
-            out_vertices[emitted++] = {position + v3 {1, 0, 1}, v3 {0, 0, 1}};
-            out_vertices[emitted++] = {position + v3 {1, 1, 1}, v3 {0, 0, 1}};
+    *out_masks = {};
+    for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+        u32 axis = direction / 2;
+        for (i32 slice = 0; slice < CHUNK_W; slice++) {
+            for (i32 v = 0; v < CHUNK_W; v++) {
+                u16 row = masks->rows[direction][slice][v];
 
-            out_vertices[emitted++] = {position + v3 {0, 0, 1}, v3 {0, 0, 1}};
-            out_vertices[emitted++] = {position + v3 {1, 1, 1}, v3 {0, 0, 1}};
-            out_vertices[emitted++] = {position + v3 {0, 1, 1}, v3 {0, 0, 1}};
+                // NOTE: Y is along u for the X faces, along the slices for
+                // the Y faces, and along v for the Z faces.
+                if (axis == 0) {
+                    row &= section_bits;
+                } else if (axis == 1) {
+                    if (slice < section_begin || slice >= section_end) row = 0;
+                } else {
+                    if (v < section_begin || v >= section_end) row = 0;
+                }
+
+                out_masks->rows[direction][slice][v] = row;
+            }
         }
+    }
+}
 
-        if (create_face_neg_z) {
-            out_vertices[emitted++] = {position + v3 {0, 0, 0}, v3 {0, 0, -1}};
-            out_vertices[emitted++] = {position + v3 {1, 1, 0}, v3 {0, 0, -1}};
-            out_vertices[emitted++] = {position + v3 {1, 0, 0}, v3 {0, 0, -1}};
+void generateBitmaskChunkMesh(ChunkFaceMasks* masks, ChunkFaceTypes* types, ChunkVertex* out_vertices, usize* out_generated_vertex_count, ChunkMeshRanges* out_ranges) {
+    usize emitted = 0;
+    for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+        out_ranges->first_vertex[direction] = emitted;
 
-            out_vertices[emitted++] = {position + v3 {0, 0, 0}, v3 {0, 0, -1}};
-            out_vertices[emitted++] = {position + v3 {0, 1, 0}, v3 {0, 0, -1}};
-            out_vertices[emitted++] = {position + v3 {1, 1, 0}, v3 {0, 0, -1}};
+        u32 axis = direction / 2;
+        b32 is_positive = (direction % 2) == 0;
+
+        for (i32 slice = 0; slice < CHUNK_W; slice++) {
+            // NOTE: Positive faces sit on the far side of the block.
+            i32 plane = is_positive ? slice + 1 : slice;
+
+            for (i32 v = 0; v < CHUNK_W; v++) {
+                u32 row = masks->rows[direction][slice][v];
+                while (row) {
+                    i32 u = __builtin_ctz(row);
+                    row &= row - 1;
+
+                    emitQuad(out_vertices, &emitted, direction, plane, u, v, 1, 1, types->types[axis][slice][v][u]);
+                }
+            }
         }
+
+        out_ranges->vertices_count[direction] = emitted - out_ranges->first_vertex[direction];
     }
 
     *out_generated_vertex_count = emitted;
 }
+
+// NOTE: The idea is to look at the chunk one slice at a time, for every face
+// direction. Each slice is a 2D mask of the visible faces, and we grow rectangles
+// greedily over that mask : first as wide as possible along u, then as tall as
+// possible along v while the whole run is still visible in the next rows.
+// With the rows stored as bitmasks, finding a run and checking it against
+// the next row are both single bit operations. Only faces of the same block
+// type can be merged, so the rows are first masked with the faces of the type
+// of the run, which is one SSE2 comparison of the row of types.
+// https://0fps.net/2012/06/30/meshing-in-a-minecraft-game/
+//
+// The counting pass runs the exact same merging without writing anything, so
+// it's a template to make sure the two can never disagree.
+inline u16 sameBlockTypeMask(u8* types_row, u8 block_type) {
+    __m128i types = _mm_loadu_si128((__m128i*)types_row);
+    return (u16)_mm_movemask_epi8(_mm_cmpeq_epi8(types, _mm_set1_epi8((char)block_type)));
+}
+
+template <b32 EMIT>
+static usize greedyMeshChunk(ChunkFaceMasks* masks, ChunkFaceTypes* types, ChunkVertex* out_vertices, ChunkMeshRanges* out_ranges) {
+    usize emitted = 0;
+    for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+        out_ranges->first_vertex[direction] = emitted;
+
+        u32 axis = direction / 2;
+        b32 is_positive = (direction % 2) == 0;
+
+        for (i32 slice = 0; slice < CHUNK_W; slice++) {
+            // NOTE: Positive faces sit on the far side of the block.
+            i32 plane = is_positive ? slice + 1 : slice;
+
+            // NOTE: Work on a copy, since merged faces get cleared.
+            u16 rows[CHUNK_W];
+            for (i32 v = 0; v < CHUNK_W; v++) {
+                rows[v] = masks->rows[direction][slice][v];
+            }
+
+            for (i32 v = 0; v < CHUNK_W; v++) {
+                while (rows[v]) {
+                    i32 u = __builtin_ctz(rows[v]);
+                    u8 block_type = types->types[axis][slice][v][u];
+                    u32 row = rows[v] & sameBlockTypeMask(types->types[axis][slice][v], block_type);
+                    // NOTE: The run ends at the first zero bit after u. The complement
+                    // of the shifted row always has bit 16 set, so this stops at the
+                    // chunk border.
+                    i32 width = __builtin_ctz(~(row >> u));
+                    u16 run = (u16)(((1u << width) - 1) << u);
+
+                    rows[v] &= ~run;
+
+                    i32 height = 1;
+                    while (v + height < CHUNK_W) {
+                        u16 next_row = rows[v + height] & sameBlockTypeMask(types->types[axis][slice][v + height], block_type);
+                        if ((next_row & run) != run) break;
+                        rows[v + height] &= ~run;
+                        height++;
+                    }
+
+                    if constexpr (EMIT) {
+                        emitQuad(out_vertices, &emitted, direction, plane, u, v, width, height, block_type);
+                    } else {
+                        emitted += 4;
+                    }
+                }
+            }
+        }
+
+        out_ranges->vertices_count[direction] = emitted - out_ranges->first_vertex[direction];
+    }
+
+    return emitted;
+}
+
+void generateGreedyChunkMesh(ChunkFaceMasks* masks, ChunkFaceTypes* types, ChunkVertex* out_vertices, usize* out_generated_vertex_count, ChunkMeshRanges* out_ranges) {
+    *out_generated_vertex_count = greedyMeshChunk<true>(masks, types, out_vertices, out_ranges);
+}
+
+usize countGreedyChunkMeshVertices(ChunkFaceMasks* masks, ChunkFaceTypes* types, ChunkMeshRanges* out_ranges) {
+    return greedyMeshChunk<false>(masks, types, nullptr, out_ranges);
+}
+
+usize countChunkMeshVertices(ChunkFaceMasks* masks, ChunkMeshRanges* out_ranges) {
+    usize vertices_count = 0;
+    for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+        out_ranges->first_vertex[direction] = vertices_count;
+
+        for (i32 slice = 0; slice < CHUNK_W; slice++) {
+            for (i32 v = 0; v < CHUNK_W; v++) {
+                vertices_count += __builtin_popcount(masks->rows[direction][slice][v]) * 4;
+            }
+        }
+
+        out_ranges->vertices_count[direction] = vertices_count - out_ranges->first_vertex[direction];
+    }
+    return vertices_count;
+}
+
+b32 raycastSolidBlock(WorldHashmap* world_hashmap, v3 origin, v3 direction, f32 max_distance, v3i* out_block_position) {
+    v3i block = {mfloor(origin.x()), mfloor(origin.y()), mfloor(origin.z())};
+
+    // NOTE: For each axis, the step to the next block, the distance along
+    // the ray to cross a whole block, and the distance to the first
+    // block boundary.
+    i32 step[3];
+    f32 delta[3];
+    f32 next_boundary[3];
+    for (u32 axis = 0; axis < 3; axis++) {
+        f32 d = direction.data[axis];
+        if (d > 0) {
+            step[axis] = 1;
+            delta[axis] = 1.f / d;
+            next_boundary[axis] = ((f32)block.data[axis] + 1.f - origin.data[axis]) * delta[axis];
+        } else if (d < 0) {
+            step[axis] = -1;
+            delta[axis] = -1.f / d;
+            next_boundary[axis] = (origin.data[axis] - (f32)block.data[axis]) * delta[axis];
+        } else {
+            step[axis] = 0;
+            delta[axis] = INFINITY;
+            next_boundary[axis] = INFINITY;
+        }
+    }
+
+    f32 distance = 0.f;
+    while (distance <= max_distance) {
+        Chunk* chunk = hashmapGet(world_hashmap, blockToChunkPos(block));
+        if (chunk) {
+            i32 local_x = block.x() - chunk->chunk_position.x() * CHUNK_W;
+            i32 local_y = block.y() - chunk->chunk_position.y() * CHUNK_W;
+            i32 local_z = block.z() - chunk->chunk_position.z() * CHUNK_W;
+            usize block_idx = local_x + local_y * CHUNK_W + local_z * CHUNK_W * CHUNK_W;
+            if (getChunkBlock(chunk, block_idx)) {
+                *out_block_position = block;
+                return true;
+            }
+        }
+
+        // NOTE: Move to the next block along the axis whose boundary is the closest.
+        u32 axis = 0;
+        if (next_boundary[1] < next_boundary[axis]) axis = 1;
+        if (next_boundary[2] < next_boundary[axis]) axis = 2;
+
+        distance = next_boundary[axis];
+        next_boundary[axis] += delta[axis];
+        block.data[axis] += step[axis];
+    }
+
+    return false;
+}
+
+void debugMeasureChunkMeshArea(ChunkVertex* vertices, usize vertices_count, f32 out_area_per_direction[FACE_DIRECTION_COUNT], f32 out_area_per_block_type[BLOCK_TYPE_COUNT]) {
+    for (u32 direction = 0; direction < FACE_DIRECTION_COUNT; direction++) {
+        out_area_per_direction[direction] = 0.f;
+    }
+    for (u32 block_type = 0; block_type < BLOCK_TYPE_COUNT; block_type++) {
+        out_area_per_block_type[block_type] = 0.f;
+    }
+
+    // NOTE: Quads are made of the triangles (0, 1, 2) and (0, 2, 3), like
+    // in the shared index buffer.
+    for (usize i = 0; i + 3 < vertices_count; i += 4) {
+        u32 direction = unpackChunkVertexFace(vertices[i]);
+        u32 block_type = unpackChunkVertexBlockType(vertices[i]);
+        ASSERT(block_type < BLOCK_TYPE_COUNT);
+
+        v3 origin = unpackChunkVertexPosition(vertices[i]);
+        v3 edge_a = unpackChunkVertexPosition(vertices[i + 1]) - origin;
+        v3 edge_b = unpackChunkVertexPosition(vertices[i + 2]) - origin;
+        v3 edge_c = unpackChunkVertexPosition(vertices[i + 3]) - origin;
+        f32 area = length(cross(edge_a, edge_b)) / 2.f + length(cross(edge_b, edge_c)) / 2.f;
+        out_area_per_direction[direction] += area;
+        out_area_per_block_type[block_type] += area;
+    }
+}
+
+void generateChunkQuadIndices(u16* out_indices) {
+    for (usize quad = 0; quad < MAX_CHUNK_QUADS; quad++) {
+        u16 first_vertex = (u16)(quad * 4);
+        out_indices[quad * 6 + 0] = first_vertex + 0;
+        out_indices[quad * 6 + 1] = first_vertex + 1;
+        out_indices[quad * 6 + 2] = first_vertex + 2;
+        out_indices[quad * 6 + 3] = first_vertex + 0;
+        out_indices[quad * 6 + 4] = first_vertex + 2;
+        out_indices[quad * 6 + 5] = first_vertex + 3;
+    }
+}
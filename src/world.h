@@ -6,31 +6,35 @@
 #include "maths.h"
 #include "gpu.h"
 #include "containers.h"
+#include "chunk_types.h"
 
-constexpr i32 CHUNK_W = 16;
-
-constexpr v3i worldPosToChunk(v3 world_pos) {
-    v3 chunk_pos = world_pos / CHUNK_W;
-
-    return v3i {
-        mfloor(chunk_pos.x()),
-        mfloor(chunk_pos.y()),
-        mfloor(chunk_pos.z()),
-    };
+// NOTE: A chunk is in the sphere of a radius if its center is within that
+// many chunks of the center of the player's chunk.
+constexpr b32 isInChunkSphere(v3i center_chunk_pos, v3i chunk_pos, i32 radius) {
+    i64 dx = (i64)chunk_pos.x() - center_chunk_pos.x();
+    i64 dy = (i64)chunk_pos.y() - center_chunk_pos.y();
+    i64 dz = (i64)chunk_pos.z() - center_chunk_pos.z();
+    return dx * dx + dy * dy + dz * dz <= (i64)radius * radius;
 }
 
-constexpr v3 chunkToWorldPos(v3i chunk_pos) {
-    return v3 {
-        (f32)(chunk_pos.x() * CHUNK_W),
-        (f32)(chunk_pos.y() * CHUNK_W),
-        (f32)(chunk_pos.z() * CHUNK_W)
-    };
+constexpr usize countChunkSphereOffsets(i32 radius) {
+    usize count = 0;
+    for (i32 x = -radius; x <= radius; x++) {
+        for (i32 y = -radius; y <= radius; y++) {
+            for (i32 z = -radius; z <= radius; z++) {
+                if (isInChunkSphere(v3i {}, v3i {x, y, z}, radius)) count++;
+            }
+        }
+    }
+    return count;
 }
 
-// NOTE: How many chunks to load around the player, in ALL 3 directions.
-// A radius of 1 would mean 7 chunks in a diamond pattern, the center one
-// being the chunk the player is inside.
-constexpr i32 LOAD_RADIUS = 8;
+// NOTE: Far chunks cover only a few pixels, so they are meshed from coarser
+// blocks: LOD 1 merges 2x2x2 blocks into one cell, LOD 2 merges 4x4x4. The
+// rings are distances in chunks from the player, past which a chunk switches
+// to the next LOD.
+constexpr u32 CHUNK_LOD_COUNT = 3;
+constexpr i32 CHUNK_LOD_RING_RADII[CHUNK_LOD_COUNT - 1] = {4, 6};
 
 // NOTE: We'll allocate a pool of chunks at startup, so that there is no memory
 // allocation for the chunk backing data at runtime. We can affort to do this
@@ -51,19 +55,118 @@ constexpr i32 LOAD_RADIUS = 8;
 constexpr usize CHUNK_POOL_SIZE = (LOAD_RADIUS * 2 + 1)
                                 * (LOAD_RADIUS * 2 + 1)
                                 * (LOAD_RADIUS * 2 + 1);
+// NOTE: The chunks stay loaded up to the unload radius, and some chunks
+// ahead of the player can be prefetched past it, so these have to fit, with
+// some room left for the chunks still generating outside of them.
+constexpr usize CHUNK_PREFETCH_MAX_CHUNKS = 1024;
+static_assert(countChunkSphereOffsets(UNLOAD_RADIUS) + CHUNK_PREFETCH_MAX_CHUNKS <= CHUNK_POOL_SIZE * 7 / 8);
+
+// NOTE: The six directions a block face can point to. Neighbor chunks are
+// also indexed using this order when needed.
+enum FaceDirection {
+    FACE_POS_X,
+    FACE_NEG_X,
+    FACE_POS_Y,
+    FACE_NEG_Y,
+    FACE_POS_Z,
+    FACE_NEG_Z,
+    FACE_DIRECTION_COUNT,
+};
+
+// NOTE: The meshers write the faces of each direction in their own contiguous
+// range of the mesh, in the FaceDirection order. That way, when drawing, we can
+// skip whole directions that can't face the camera.
+struct ChunkMeshRanges {
+    u32 first_vertex[FACE_DIRECTION_COUNT];
+    u32 vertices_count[FACE_DIRECTION_COUNT];
+};
+
+// NOTE: Chunk meshes are split into horizontal sections, so that editing a
+// block only needs the section(s) around it to be remeshed and uploaded. A
+// face belongs to the section of the block it is on.
+constexpr u32 CHUNK_MESH_SECTIONS = 4;
+constexpr i32 CHUNK_SECTION_H = CHUNK_W / CHUNK_MESH_SECTIONS;
+constexpr u8 ALL_CHUNK_SECTIONS = (1 << CHUNK_MESH_SECTIONS) - 1;
+
+// NOTE: Where every section of every face direction lives in the chunk's
+// vertex buffer. The slots are ordered by direction first, so the sections of
+// a direction are contiguous and still drawn with a single draw call. Slots
+// are a bit bigger than their mesh, and the unused vertices are zeroed so they
+// make degenerate triangles. That leaves some room for the mesh of a section
+// to grow after an edit without having to move the other sections around.
+struct ChunkMeshSlots {
+    u32 first_vertex[FACE_DIRECTION_COUNT][CHUNK_MESH_SECTIONS];
+    u32 capacity[FACE_DIRECTION_COUNT][CHUNK_MESH_SECTIONS];
+};
+
+// NOTE: The per-frame loops that only care about some of the loaded chunks
+// go through dense lists of them instead of the whole pool.
+enum ChunkListKind {
+    // NOTE: needs_remeshing or dirty_sections is set.
+    CHUNK_LIST_DIRTY,
+    // NOTE: The mesh is not empty, so the chunk may be drawn.
+    CHUNK_LIST_VISIBLE,
+    // NOTE: Loaded ahead of the player, outside of the unload sphere.
+    CHUNK_LIST_PREFETCHED,
+
+    CHUNK_LIST_COUNT,
+};
 
 struct Chunk {
     b32 is_loaded;
+    // NOTE: The chunk is in the world, but a worker is still generating its
+    // blocks. Until then it is not meshed or unloaded, and its neighbors are
+    // meshed as if it was solid.
+    b32 is_generating;
+    // NOTE: Loaded by prefetching, and hasn't entered the load sphere yet.
+    b32 is_prefetched;
 
     v3i chunk_position;
-    u8 data[CHUNK_W * CHUNK_W * CHUNK_W];
 
+    // NOTE: If every block of the chunk is the same, the chunk is "uniform" :
+    // blocks is NULL and all the blocks are uniform_block.
+    ChunkBlocks* blocks;
+    u8 uniform_block;
+
+    // NOTE: needs_remeshing rebuilds the whole mesh, dirty_sections (one bit
+    // per section) only rebuilds these sections in place if they still fit.
     b32 needs_remeshing;
+    u8 dirty_sections;
+    u8 lod;
     usize vertices_count;
+    ChunkMeshRanges mesh_ranges;
+    ChunkMeshSlots mesh_slots;
 
     AllocatedBuffer vertex_buffer;
+
+    // NOTE: The position of the chunk in each chunk list, plus one, so that
+    // zero (and a zeroed chunk) means it isn't in any.
+    u16 list_positions[CHUNK_LIST_COUNT];
+};
+
+// NOTE: A chunk is removed by moving the last one of the list in its place,
+// so loops that remove chunks while iterating have to go backwards.
+struct ChunkList {
+    Chunk* chunks[CHUNK_POOL_SIZE];
+    usize count;
 };
 
+void addChunkToList(ChunkList* list, ChunkListKind kind, Chunk* chunk);
+void removeChunkFromList(ChunkList* list, ChunkListKind kind, Chunk* chunk);
+
+inline u8 getChunkBlock(Chunk* chunk, usize block_idx) {
+    return chunk->blocks ? chunk->blocks->data[block_idx] : chunk->uniform_block;
+}
+
+inline v3i blockToChunkPos(v3i block_position) {
+    v3i result;
+    for (u32 axis = 0; axis < 3; axis++) {
+        i32 coord = block_position.data[axis];
+        result.data[axis] = (coord < 0 ? coord - (CHUNK_W - 1) : coord) / CHUNK_W;
+    }
+    return result;
+}
+
 // NOTE: The actual world will modeled using a hashmap that associates world
 // coordinates to chunk handles. This is JUST FOR ACCESS/QUERY. No game world
 // related memory is managed or owned by the hashmap. There are surely smarter
@@ -74,22 +177,81 @@ struct Chunk {
 // number of chunks we have in the pool is actually a good approximation, since
 // that number is already higher than the number of chunks we'll have loaded at
 // a time.
-constexpr usize nextPowerOfTwo(usize n) {
-    usize value = 2;
-    while (value < n) {
-        value *= 2;
-    }
-    return value;
-}
 constexpr usize WORLD_HASHMAP_SIZE = nextPowerOfTwo(CHUNK_POOL_SIZE);
 
-// TODO: This can surely be optimized. We don't need a v3 (96 bits) to store the
-// normal vector when we have only 6 different normal directions (3 bits) !
+// NOTE: The offsets of a sphere of chunks, computed once. The shell of a face
+// direction is the offsets o of the sphere such that o + direction is not in
+// it. When the player moves one chunk in a direction, the chunks entering
+// the sphere are the shell of that direction around the new chunk, and the
+// ones leaving it are the shell of the opposite direction around the old
+// chunk, so streaming never has to look at the whole sphere. A line along the
+// direction crosses the shell once, so a shell has at most one offset per
+// line. Offsets are sorted by x, then z, then y, so that the chunks of a
+// column come one after the other.
+// The load and unload spheres both use this, sized for the biggest one.
+constexpr usize CHUNK_SPHERE_MAX_OFFSETS = countChunkSphereOffsets(UNLOAD_RADIUS);
+constexpr usize CHUNK_SHELL_MAX_OFFSETS = (UNLOAD_RADIUS * 2 + 1) * (UNLOAD_RADIUS * 2 + 1);
+
+struct ChunkSphereOffsets {
+    i32 radius;
+    v3i sphere[CHUNK_SPHERE_MAX_OFFSETS];
+    usize sphere_count;
+    v3i shells[FACE_DIRECTION_COUNT][CHUNK_SHELL_MAX_OFFSETS];
+    usize shells_count[FACE_DIRECTION_COUNT];
+};
+
+void buildChunkSphereOffsets(i32 radius, ChunkSphereOffsets* out_offsets);
+
+// NOTE: Chunk vertices are packed into a single u32, the shaders unpack them.
+// Positions are local to the chunk and go from 0 to CHUNK_W included, so they
+// need 5 bits per axis. The normal is one of the 6 face directions (3 bits).
+// There is also room for ambient occlusion and the block type. The layout is :
+// - bits  0..4  : x
+// - bits  5..9  : y
+// - bits 10..14 : z
+// - bits 15..17 : face direction
+// - bits 18..19 : ambient occlusion
+// - bits 20..27 : block type
+// - bits 28..31 : unused
+// It has to be kept in sync with debug_chunk.vert and wireframe.vert !
 struct ChunkVertex {
-    v3 position;
-    v3 normal;
+    u32 packed;
 };
 
+constexpr u32 CHUNK_VERTEX_POSITION_BITS = 5;
+constexpr u32 CHUNK_VERTEX_POSITION_MASK = (1 << CHUNK_VERTEX_POSITION_BITS) - 1;
+constexpr u32 CHUNK_VERTEX_FACE_SHIFT = 15;
+constexpr u32 CHUNK_VERTEX_AO_SHIFT = 18;
+constexpr u32 CHUNK_VERTEX_BLOCK_TYPE_SHIFT = 20;
+static_assert(CHUNK_W <= CHUNK_VERTEX_POSITION_MASK, "Chunk vertex positions don't fit in 5 bits.");
+
+inline ChunkVertex packChunkVertex(u32 x, u32 y, u32 z, u32 face_direction, u32 ao = 0, u32 block_type = 0) {
+    ChunkVertex result;
+    result.packed = x
+                  | (y << CHUNK_VERTEX_POSITION_BITS)
+                  | (z << (CHUNK_VERTEX_POSITION_BITS * 2))
+                  | (face_direction << CHUNK_VERTEX_FACE_SHIFT)
+                  | (ao << CHUNK_VERTEX_AO_SHIFT)
+                  | (block_type << CHUNK_VERTEX_BLOCK_TYPE_SHIFT);
+    return result;
+}
+
+inline v3 unpackChunkVertexPosition(ChunkVertex vertex) {
+    return v3 {
+        (f32)(vertex.packed & CHUNK_VERTEX_POSITION_MASK),
+        (f32)((vertex.packed >> CHUNK_VERTEX_POSITION_BITS) & CHUNK_VERTEX_POSITION_MASK),
+        (f32)((vertex.packed >> (CHUNK_VERTEX_POSITION_BITS * 2)) & CHUNK_VERTEX_POSITION_MASK),
+    };
+}
+
+inline u32 unpackChunkVertexFace(ChunkVertex vertex) {
+    return (vertex.packed >> CHUNK_VERTEX_FACE_SHIFT) & 0x7;
+}
+
+inline u32 unpackChunkVertexBlockType(ChunkVertex vertex) {
+    return (vertex.packed >> CHUNK_VERTEX_BLOCK_TYPE_SHIFT) & 0xFF;
+}
+
 // NOTE: ChatGPT wrote that. I hope it's a good hash.
 // It uses prime numbers so you know it must be.
 constexpr usize chunkPositionHash(v3i chunk_position) {
@@ -102,5 +264,107 @@ constexpr usize chunkPositionHash(v3i chunk_position) {
 
 using WorldHashmap = Hashmap<Chunk*, v3i, WORLD_HASHMAP_SIZE, chunkPositionHash>;
 
-// TODO: Look into switching to greedy meshing.
-void generateNaiveChunkMesh(WorldHashmap* world_hashmap, Chunk* chunk, ChunkVertex* out_vertices, usize* out_generated_vertex_count);
+// NOTE: The meshing algorithm can be switched at runtime, mostly
+// so we can compare them.
+enum ChunkMesher {
+    CHUNK_MESHER_NAIVE,
+    CHUNK_MESHER_BITMASK,
+    CHUNK_MESHER_GREEDY,
+    CHUNK_MESHER_COUNT,
+};
+
+// NOTE: The input of all the meshers : a copy of the chunk's blocks, with a
+// one block border taken from the six neighbors. It is gathered once before
+// meshing, so the meshers never have to look up the neighbors themselves (no
+// hashmap probes in the inner loops), and since it is a standalone copy the
+// meshing could run on another thread while the world keeps changing.
+constexpr i32 PADDED_CHUNK_W = CHUNK_W + 2;
+struct PaddedChunk {
+    u8 data[PADDED_CHUNK_W * PADDED_CHUNK_W * PADDED_CHUNK_W];
+};
+
+// NOTE: Blocks in neighbors that are not loaded are considered solid, so
+// that no faces are created at the boundary with them.
+void gatherPaddedChunk(WorldHashmap* world_hashmap, Chunk* chunk, PaddedChunk* out_padded);
+
+// NOTE: Replaces the chunk's blocks with cells of (1 << lod) blocks, that are
+// solid if any of their blocks is. The border is left untouched: faces at the
+// boundary are still culled against the full resolution blocks of the
+// neighbors, and since a coarse chunk is always a superset of its blocks, that
+// never leaves holes at the seam with a neighbor of a different LOD. This
+// also means that changing the LOD of a chunk doesn't remesh its neighbors.
+// Only the greedy mesher turns the bigger cells into fewer quads.
+void downsamplePaddedChunk(PaddedChunk* padded, u32 lod);
+
+// NOTE: Fast path for uniform chunks. Returns true if we know the chunk's mesh
+// is empty without meshing it : it is only air, or it is only solid blocks and
+// all the blocks touching it in the neighbors are solid too.
+b32 isChunkMeshTriviallyEmpty(WorldHashmap* world_hashmap, Chunk* chunk);
+
+// NOTE: The meshers emit quads as 4 vertices, and all the chunks are drawn
+// with the same index buffer that splits every quad into the triangles
+// (0, 1, 2) and (0, 2, 3). The worst case mesh is a 3D checkerboard : half the
+// blocks are solid and every one of them has its 6 faces visible.
+constexpr usize MAX_CHUNK_QUADS = (CHUNK_W * CHUNK_W * CHUNK_W / 2) * FACE_DIRECTION_COUNT;
+constexpr usize MAX_CHUNK_VERTICES = MAX_CHUNK_QUADS * 4;
+constexpr usize MAX_CHUNK_INDICES = MAX_CHUNK_QUADS * 6;
+static_assert(MAX_CHUNK_VERTICES <= 65536, "Chunk vertices can't be indexed with u16.");
+
+// NOTE: Fills the shared index buffer, out_indices must hold MAX_CHUNK_INDICES.
+void generateChunkQuadIndices(u16* out_indices);
+
+// NOTE: The visible faces of a chunk, as bitmasks. For each face direction,
+// the chunk is cut into slices along that direction's axis, and each slice
+// is a 16x16 grid of faces stored as 16 rows of 16 bits. The two axes of the
+// grid (u, v) are the two other axes in cyclic order, e.g. for the X axis u is
+// Y and v is Z. So rows[FACE_POS_X][x][z] has bit y set if the block at
+// (x, y, z) is solid and the one at (x + 1, y, z) is not.
+static_assert(CHUNK_W == 16, "The face masks assume 16 blocks per row.");
+struct ChunkFaceMasks {
+    u16 rows[FACE_DIRECTION_COUNT][CHUNK_W][CHUNK_W];
+};
+
+// NOTE: Computes the visible faces of the chunk with bitwise operations on
+// whole rows of blocks instead of testing the neighbors of each block.
+void buildChunkFaceMasks(PaddedChunk* padded, ChunkFaceMasks* out_masks);
+
+// NOTE: The type of the block behind every face, in the same layout as the
+// face masks: types[axis][slice][v][u] is the block at u in the row v of the
+// slice, for both face directions of the axis. A row of types is 16
+// contiguous bytes, so the greedy mesher can compare a whole row against a
+// block type in one go. The meshers that only look at the face masks need
+// them to know the type of the faces they emit.
+struct ChunkFaceTypes {
+    u8 types[3][CHUNK_W][CHUNK_W][CHUNK_W];
+};
+
+void buildChunkFaceTypes(PaddedChunk* padded, ChunkFaceTypes* out_types);
+
+// NOTE: Keeps only the faces of one mesh section. The other meshers only see
+// face masks, so they mesh a single section when given restricted masks.
+void restrictChunkFaceMasksToSection(ChunkFaceMasks* masks, u32 section, ChunkFaceMasks* out_masks);
+
+void generateNaiveChunkMesh(PaddedChunk* padded, u32 section, ChunkVertex* out_vertices, usize* out_generated_vertex_count, ChunkMeshRanges* out_ranges);
+// NOTE: Same output as the naive mesher (one quad per visible face), but
+// generated from the face masks.
+void generateBitmaskChunkMesh(ChunkFaceMasks* masks, ChunkFaceTypes* types, ChunkVertex* out_vertices, usize* out_generated_vertex_count, ChunkMeshRanges* out_ranges);
+// NOTE: Same faces as the naive mesher, but coplanar faces of the same block
+// type are merged into the biggest rectangles possible, which means way fewer
+// vertices.
+void generateGreedyChunkMesh(ChunkFaceMasks* masks, ChunkFaceTypes* types, ChunkVertex* out_vertices, usize* out_generated_vertex_count, ChunkMeshRanges* out_ranges);
+
+// NOTE: Exact mesh sizes, computed before meshing so the vertices can be
+// written straight to GPU-visible memory without reserving the worst case.
+// The naive and bitmask meshers both emit one quad per visible face. The
+// ranges are filled exactly like the mesher would.
+usize countChunkMeshVertices(ChunkFaceMasks* masks, ChunkMeshRanges* out_ranges);
+usize countGreedyChunkMeshVertices(ChunkFaceMasks* masks, ChunkFaceTypes* types, ChunkMeshRanges* out_ranges);
+
+// NOTE: Walks the blocks along a ray (Amanatides & Woo) and returns the first
+// solid one. Blocks in chunks that are not loaded are considered air.
+b32 raycastSolidBlock(WorldHashmap* world_hashmap, v3 origin, v3 direction, f32 max_distance, v3i* out_block_position);
+
+// NOTE: Debug helper that sums the area of the quads of a mesh for each
+// face direction and each block type. Two meshers fed the same chunk should
+// produce meshes covering the exact same surface, with the same blocks.
+void debugMeasureChunkMeshArea(ChunkVertex* vertices, usize vertices_count, f32 out_area_per_direction[FACE_DIRECTION_COUNT], f32 out_area_per_block_type[BLOCK_TYPE_COUNT]);
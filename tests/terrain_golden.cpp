@@ -0,0 +1,246 @@
+// NOTE: Headless regression test and benchmark for the terrain generator.
+// It only needs terrain.cpp and noise.cpp, so it runs on any machine with
+// clang, without the platform layer or Vulkan. Build and run it with
+// `python build.py terrain_golden`. It has to be built with the same float
+// settings as the game (no contraction of multiplies and adds), or the
+// golden hashes won't match. The program exits with an error if any SIMD
+// path of the noise differs from the scalar version, or any hash differs.
+
+#include <stdio.h>
+#include <time.h>
+
+#include "../src/terrain.h"
+#include "../src/noise.h"
+
+// NOTE: Regression check for the generator. The blocks of a fixed set of
+// chunks are hashed for every preset, and compared against the hashes of the
+// last known good terrain. Speeding up the noise or the generation must not
+// change a single block, so a mismatch is a bug, unless the terrain was
+// changed on purpose, in which case the golden hashes have to be updated.
+// The chunks are around the surface of the presets, so that most of them are
+// not uniform, and some are far from the origin, where the float precision is the worst.
+constexpr v3i TERRAIN_GOLDEN_CHUNKS[] = {
+    v3i {0, 0, 0},
+    v3i {0, 3, 0},
+    v3i {1, 1, -1},
+    v3i {1, 3, -1},
+    v3i {-3, 0, 5},
+    v3i {7, -1, -2},
+    v3i {7, 1, -2},
+    v3i {7, 4, -2},
+    v3i {40, 1, 17},
+    v3i {40, 5, 17},
+    v3i {-250, 1, 300},
+    v3i {1 << 20, 0, -(1 << 20)},
+};
+constexpr usize TERRAIN_GOLDEN_CHUNKS_COUNT = ARRAY_COUNT(TERRAIN_GOLDEN_CHUNKS);
+
+// NOTE: In the order of TERRAIN_PRESETS. This program prints the hashes it
+// computes, so they can be copied here when the terrain changes on purpose.
+constexpr u64 TERRAIN_GOLDEN_HASHES[TERRAIN_PRESETS_COUNT][TERRAIN_GOLDEN_CHUNKS_COUNT] = {
+    {
+        0xEFE6EA6A50B8C75A, 0xB93A0C83CE3B6325, 0x647C224E4EC68986, 0xB93A0C83CE3B6325,
+        0x3EBE7C7DA6070C4A, 0x13411B19E5157325, 0x3BC7A48997A737C1, 0xB93A0C83CE3B6325,
+        0x50890C5C662268CC, 0xB93A0C83CE3B6325, 0xF087A0454FC1D85D, 0x3A0EB8B7D50CF5FC,
+    },
+    {
+        0x13411B19E5157325, 0x78E2FDAA169A0BA9, 0xA3BCEB0523ED5CC1, 0x3EB703CAF8F48A44,
+        0x13411B19E5157325, 0x13411B19E5157325, 0x13411B19E5157325, 0xDB3A7EDA1DCDF4C3,
+        0x13411B19E5157325, 0xCC89D8FEEA0F2D36, 0x13411B19E5157325, 0x13411B19E5157325,
+    },
+    {
+        0xB84390EC95039DC7, 0xB93A0C83CE3B6325, 0x312F8CB2BC5FB531, 0x2AFF76C64C9F2BB6,
+        0x5E18A9C63A2DCCDE, 0x42B907A20C3AF6BC, 0xCCCE3A98C1AA5332, 0xB93A0C83CE3B6325,
+        0xFD2B85FCBEBC7BFF, 0xB93A0C83CE3B6325, 0x322B6CB5348BFA5E, 0x3B44E00C2E6074B6,
+    },
+    {
+        0x051492AE979670D7, 0xB93A0C83CE3B6325, 0x26F288B612B5AA55, 0x8E4ADFBBB998F3F2,
+        0x140BC36E89B80559, 0xF81F7965D2717D26, 0xCB49688468A8B6D7, 0xB93A0C83CE3B6325,
+        0x7E210851DEC021C7, 0xB93A0C83CE3B6325, 0x168FDD08FA810125, 0x935C2B2A422D1696,
+    },
+    {
+        0x7DD0AB9DC0D51C13, 0xB93A0C83CE3B6325, 0xB80944CC24613DB8, 0x74062B35B051C36C,
+        0xD5D22E01DE48E6E8, 0xB30BD7FECD7A5222, 0x2E3C9AF8DF6E863F, 0xB93A0C83CE3B6325,
+        0x92CC25E3E84CDDFC, 0xB93A0C83CE3B6325, 0x9A2AA7F5AC95F90C, 0x14876AD773F3AD13,
+    },
+};
+
+// NOTE: FNV-1a over the blocks. Not for hashmaps, only to tell if two chunks
+// are (almost certainly) identical.
+static u64 hashChunkBlocks(ChunkBlocks* blocks) {
+    u64 hash = 0xCBF29CE484222325;
+    for (usize block_idx = 0; block_idx < CHUNK_W * CHUNK_W * CHUNK_W; block_idx++) {
+        hash ^= blocks->data[block_idx];
+        hash *= 0x100000001B3;
+    }
+    return hash;
+}
+
+// NOTE: The golden chunks are generated this many times, to get stable timings.
+constexpr u32 TIMING_REPETITIONS = 16;
+
+// NOTE: Same chunks as the in-game benchmark (B): away from the world
+// horizontally, and around the surface vertically.
+constexpr i32 BENCHMARK_CHUNKS_W = 4;
+constexpr i32 BENCHMARK_CHUNKS_OFFSET = 1 << 12;
+
+static f64 getSeconds() {
+    timespec time = {};
+    timespec_get(&time, TIME_UTC);
+    return (f64)time.tv_sec + (f64)time.tv_nsec * 1e-9;
+}
+
+static const char* PRESET_NAMES[TERRAIN_PRESETS_COUNT] = {
+    "hills",
+    "mountains",
+    "cliffs (quality)",
+    "cliffs",
+    "cliffs (fast)",
+};
+
+// NOTE: The noise is checked on its own too, on way more points than the
+// golden chunks sample: every SIMD path the CPU supports has to give the
+// exact same bits as the scalar functions. The counts are not multiples of
+// the lanes, so the leftover points are covered too.
+constexpr usize NOISE_CHECK_POINTS_COUNT = (1 << 18) + 7;
+constexpr u64 NOISE_CHECK_SEED = 0xC0FFEE;
+constexpr u32 NOISE_PATHS_LANES[] = {1, 4, 8, 16};
+
+global f32 noise_xs[NOISE_CHECK_POINTS_COUNT];
+global f32 noise_ys[NOISE_CHECK_POINTS_COUNT];
+global f32 noise_zs[NOISE_CHECK_POINTS_COUNT];
+global f32 noise_values[NOISE_CHECK_POINTS_COUNT];
+
+global ChunkBlocks blocks;
+
+// NOTE: xorshift, only to spread the points around.
+static f32 randomCoordinate(u64* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+
+    // NOTE: Spans from a few blocks to far away from the origin, both signs.
+    constexpr f32 RANGES[] = {4.f, 300.f, 40000.f, 4000000.f};
+    f32 unit = (f32)(*state >> 40) / (f32)(1 << 24);
+    return (unit - 0.5f) * RANGES[(*state >> 8) % ARRAY_COUNT(RANGES)];
+}
+
+static u32 checkNoisePath(u32 lanes) {
+    u32 mismatches_count = 0;
+
+    simplex_noise_2d_batch(NOISE_CHECK_SEED, noise_xs, noise_ys, noise_values, NOISE_CHECK_POINTS_COUNT);
+    for (usize point_idx = 0; point_idx < NOISE_CHECK_POINTS_COUNT; point_idx++) {
+        f32 expected = simplex_noise_2d(NOISE_CHECK_SEED, noise_xs[point_idx], noise_ys[point_idx]);
+        if (__builtin_bit_cast(u32, noise_values[point_idx]) != __builtin_bit_cast(u32, expected)) mismatches_count++;
+    }
+
+    simplex_noise_3d_batch(NOISE_CHECK_SEED, noise_xs, noise_ys, noise_zs, noise_values, NOISE_CHECK_POINTS_COUNT);
+    for (usize point_idx = 0; point_idx < NOISE_CHECK_POINTS_COUNT; point_idx++) {
+        f32 expected = simplex_noise_3d(NOISE_CHECK_SEED, noise_xs[point_idx], noise_ys[point_idx], noise_zs[point_idx]);
+        if (__builtin_bit_cast(u32, noise_values[point_idx]) != __builtin_bit_cast(u32, expected)) mismatches_count++;
+    }
+
+    printf("noise, %u lanes: %s\n", lanes, mismatches_count == 0 ? "ok" : "MISMATCH");
+    return mismatches_count;
+}
+
+// NOTE: Returns how many golden chunks don't match, with the current noise
+// path.
+static u32 checkGoldenChunks(b32 is_verbose) {
+    u32 mismatches_count = 0;
+
+    for (u32 preset_idx = 0; preset_idx < TERRAIN_PRESETS_COUNT; preset_idx++) {
+        TerrainDescription preset = *TERRAIN_PRESETS[preset_idx];
+
+        if (is_verbose) printf("%s:\n", PRESET_NAMES[preset_idx]);
+        for (usize golden_idx = 0; golden_idx < TERRAIN_GOLDEN_CHUNKS_COUNT; golden_idx++) {
+            v3i chunk_position = TERRAIN_GOLDEN_CHUNKS[golden_idx];
+            generateChunkBlocks(&preset, chunk_position, &blocks);
+
+            u64 hash = hashChunkBlocks(&blocks);
+            b32 is_match = hash == TERRAIN_GOLDEN_HASHES[preset_idx][golden_idx];
+            if (!is_match) mismatches_count++;
+
+            if (is_verbose) {
+                printf("    {%d, %d, %d}: 0x%016llX %s\n",
+                       chunk_position.x(), chunk_position.y(), chunk_position.z(),
+                       (unsigned long long)hash, is_match ? "ok" : "MISMATCH");
+            }
+        }
+    }
+
+    return mismatches_count;
+}
+
+int main() {
+    simplex_noise_init_dispatch();
+    u32 widest_lanes = simplex_noise_batch_lanes();
+
+    u32 noise_mismatches_count = 0;
+    u32 golden_mismatches_count = 0;
+
+    u64 random_state = 0x9E3779B97F4A7C15;
+    for (usize point_idx = 0; point_idx < NOISE_CHECK_POINTS_COUNT; point_idx++) {
+        noise_xs[point_idx] = randomCoordinate(&random_state);
+        noise_ys[point_idx] = randomCoordinate(&random_state);
+        noise_zs[point_idx] = randomCoordinate(&random_state);
+    }
+
+    // NOTE: The narrower paths only report the golden chunks that fail.
+    for (u32 path_idx = 0; path_idx < ARRAY_COUNT(NOISE_PATHS_LANES); path_idx++) {
+        u32 lanes = NOISE_PATHS_LANES[path_idx];
+        if (!simplex_noise_set_batch_lanes(lanes)) {
+            printf("noise, %u lanes: not supported by this CPU\n", lanes);
+            continue;
+        }
+
+        noise_mismatches_count += checkNoisePath(lanes);
+        if (lanes != widest_lanes) {
+            u32 mismatches_count = checkGoldenChunks(false);
+            if (mismatches_count > 0) printf("    %u golden chunks don't match with %u lanes\n", mismatches_count, lanes);
+            golden_mismatches_count += mismatches_count;
+        }
+    }
+
+    simplex_noise_set_batch_lanes(widest_lanes);
+    golden_mismatches_count += checkGoldenChunks(true);
+
+    printf("generation, %u lanes:\n", widest_lanes);
+    for (u32 preset_idx = 0; preset_idx < TERRAIN_PRESETS_COUNT; preset_idx++) {
+        TerrainDescription preset = *TERRAIN_PRESETS[preset_idx];
+
+        f64 golden_start = getSeconds();
+        for (u32 repetition = 0; repetition < TIMING_REPETITIONS; repetition++) {
+            for (usize golden_idx = 0; golden_idx < TERRAIN_GOLDEN_CHUNKS_COUNT; golden_idx++) {
+                generateChunkBlocks(&preset, TERRAIN_GOLDEN_CHUNKS[golden_idx], &blocks);
+            }
+        }
+        f64 golden_seconds = getSeconds() - golden_start;
+        f64 golden_chunks_count = (f64)TIMING_REPETITIONS * (f64)TERRAIN_GOLDEN_CHUNKS_COUNT;
+
+        f64 benchmark_start = getSeconds();
+        for (i32 x = 0; x < BENCHMARK_CHUNKS_W; x++) {
+            for (i32 y = 0; y < BENCHMARK_CHUNKS_W; y++) {
+                for (i32 z = 0; z < BENCHMARK_CHUNKS_W; z++) {
+                    v3i chunk_position = v3i {BENCHMARK_CHUNKS_OFFSET + x, y - BENCHMARK_CHUNKS_W / 2 + 1, BENCHMARK_CHUNKS_OFFSET + z};
+                    generateChunkBlocks(&preset, chunk_position, &blocks);
+                }
+            }
+        }
+        f64 benchmark_seconds = getSeconds() - benchmark_start;
+        f64 benchmark_chunks_count = (f64)(BENCHMARK_CHUNKS_W * BENCHMARK_CHUNKS_W * BENCHMARK_CHUNKS_W);
+
+        printf("    %s: golden chunks %.1f us/chunk, benchmark chunks %.1f us/chunk\n",
+               PRESET_NAMES[preset_idx],
+               golden_seconds * 1e6 / golden_chunks_count,
+               benchmark_seconds * 1e6 / benchmark_chunks_count);
+    }
+
+    if (noise_mismatches_count > 0 || golden_mismatches_count > 0) {
+        printf("FAILED: %u noise points and %u golden chunks don't match\n", noise_mismatches_count, golden_mismatches_count);
+        return 1;
+    }
+
+    printf("ALL NOISE PATHS AND GOLDEN CHUNKS MATCH\n");
+    return 0;
+}